@@ -0,0 +1,97 @@
+#include "ArgParse.h"
+#include "benchTimer.h"
+#include <stdio.h>
+
+#define COMMANDS 500
+#define ARGS     20
+#define ROUNDS   20
+
+// 构造一个带子命令与选项的规格
+static ArgParse *buildSpec(bool arena) {
+    ArgParse *argparse = arena ? argParseInitWithArena("bench", ArgParseNOVALUE)
+                               : argParseInit("bench", ArgParseNOVALUE);
+    char      name[32];
+    char      long_opt[32];
+
+    for (int i = 0; i < COMMANDS; i++) {
+        snprintf(name, sizeof(name), "command-%d", i);
+        Command *command = argParseAddCommand(argparse,
+                                              name,
+                                              "Generated command",
+                                              NULL,
+                                              NULL,
+                                              NULL,
+                                              ArgParseNOVALUE);
+        Command *sub     = argParseAddSubCommand(command,
+                                             "run",
+                                             "Generated subcommand",
+                                             NULL,
+                                             NULL,
+                                             NULL,
+                                             ArgParseMULTIVALUE);
+        for (int j = 0; j < ARGS; j++) {
+            snprintf(name, sizeof(name), "-o%d", j);
+            snprintf(long_opt, sizeof(long_opt), "--option-%d", j);
+            argParseAddArg(command,
+                           name,
+                           long_opt,
+                           "Generated option",
+                           "default",
+                           NULL,
+                           false,
+                           ArgParseSINGLEVALUE);
+            argParseAddArg(sub,
+                           name,
+                           long_opt,
+                           "Generated option",
+                           NULL,
+                           NULL,
+                           false,
+                           ArgParseNOVALUE);
+        }
+    }
+    return argparse;
+}
+
+static void bench(bool arena) {
+    double build    = 0;
+    double teardown = 0;
+    size_t allocs   = 0;
+
+    // 计数只在单独一轮中进行，计时不受计数头部影响
+    ArgParseAllocStats stats;
+    argParseUseCountingAllocator(&stats);
+    argParseFree(buildSpec(arena));
+    allocs = stats.count;
+    argParseUseCountingAllocator(NULL);
+
+    for (int round = 0; round < ROUNDS; round++) {
+        double    start    = benchNow();
+        ArgParse *argparse = buildSpec(arena);
+        double    built    = benchNow();
+        argParseFree(argparse);
+        teardown += benchNow() - built;
+        build += built - start;
+    }
+
+    printf("%-6s %12zu %14.3f %14.3f\n",
+           arena ? "arena" : "heap",
+           allocs,
+           build / ROUNDS / 1e6,
+           teardown / ROUNDS / 1e6);
+}
+
+int main(int argc, char *argv[]) {
+    printf("spec: %d commands, %d subcommands, %d options\n",
+           COMMANDS,
+           COMMANDS,
+           COMMANDS * ARGS * 2);
+    printf("%-6s %12s %14s %14s\n",
+           "mode",
+           "allocations",
+           "build(ms)",
+           "free(ms)");
+    bench(false);
+    bench(true);
+    return 0;
+}
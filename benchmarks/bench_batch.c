@@ -0,0 +1,166 @@
+#include "ArgParse.h"
+#include "ArgParseTools.h"
+#include "benchTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LINES    200000
+#define ROUNDS   3
+#define COMMANDS 64
+#define ARGS     8
+#define ARGV_LEN 10
+
+static ArgParse *buildSpec(void) {
+    ArgParse *argparse = argParseInit("batch bench", ArgParseNOVALUE);
+    char      name[32];
+    char      short_opt[8];
+    char      long_opt[32];
+
+    argParseAddGlobalArg(argparse,
+                         "-v",
+                         "--verbose",
+                         "verbose",
+                         NULL,
+                         NULL,
+                         false,
+                         ArgParseNOVALUE);
+    for (int i = 0; i < COMMANDS; i++) {
+        snprintf(name, sizeof(name), "command-%d", i);
+        Command *command = argParseAddCommand(
+            argparse, name, "bench", NULL, NULL, NULL, ArgParseNOVALUE);
+        for (int j = 0; j < ARGS; j++) {
+            snprintf(short_opt, sizeof(short_opt), "-%c", 'a' + j);
+            snprintf(long_opt, sizeof(long_opt), "--option-%d", j);
+            argParseAddArg(command,
+                           short_opt,
+                           long_opt,
+                           "bench option",
+                           NULL,
+                           NULL,
+                           false,
+                           j == 0 ? ArgParseMULTIVALUE : ArgParseSINGLEVALUE);
+        }
+    }
+    return argparse;
+}
+
+static char _Names[COMMANDS][32];
+
+// 每条命令行分派到不同命令，每16条中有一条带未知选项
+static void makeLines(ArgParseArgv *lines, char **storage) {
+    for (int i = 0; i < COMMANDS; i++) {
+        snprintf(_Names[i], sizeof(_Names[i]), "command-%d", i);
+    }
+    for (int i = 0; i < LINES; i++) {
+        char **argv = storage + (size_t)i * ARGV_LEN;
+        argv[0]     = "bench";
+        argv[1]     = "-v";
+        argv[2]     = _Names[i % COMMANDS];
+        argv[3]     = "--option-0";
+        argv[4]     = "a.txt";
+        argv[5]     = "b.txt";
+        argv[6]     = "c.txt";
+        argv[7]     = i % 16 == 15 ? "--unknown" : "-b";
+        argv[8]     = "value";
+        argv[9]     = "--option-5";
+        lines[i]    = (ArgParseArgv){ARGV_LEN, argv};
+    }
+}
+
+// 逐条argParseParseResult并释放，作为单线程的对照
+static double benchSerial(ArgParse *spec, const ArgParseArgv *lines) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        double start = benchNow();
+        for (int i = 0; i < LINES; i++) {
+            argParseResultFree(argParseParseResult(
+                argParseGetSpec(spec), lines[i].argc, lines[i].argv));
+        }
+        double elapsed = benchNow() - start;
+        if (round == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+static double benchBatch(ArgParse           *spec,
+                         const ArgParseArgv *lines,
+                         ArgParseErrorInfo  *results,
+                         int                 threads,
+                         int                *failed) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        double start   = benchNow();
+        *failed        = argParseParseBatch(
+            argParseGetSpec(spec), lines, LINES, threads, results);
+        double elapsed = benchNow() - start;
+        if (round == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+// 线程数按2的幂递增，最后一档总是全部CPU
+static int nextThreads(int threads, int cpus) {
+    if (threads < cpus && threads * 2 > cpus) {
+        return cpus;
+    }
+    return threads * 2;
+}
+
+// 可用第一个参数指定最多测到的线程数，默认为全部在线CPU
+int main(int argc, char *argv[]) {
+    ArgParse *spec = buildSpec();
+    argParseSetExitOnError(spec, false);
+    argParseCompile(spec);
+
+    ArgParseArgv      *lines   = malloc(LINES * sizeof(ArgParseArgv));
+    char             **storage = malloc(LINES * ARGV_LEN * sizeof(char *));
+    ArgParseErrorInfo *results = malloc(LINES * sizeof(ArgParseErrorInfo));
+    makeLines(lines, storage);
+
+    int cpus = argc > 1 ? atoi(argv[1]) : argParseCpuCount();
+    printf("%d lines, %d commands x %d options, up to %d threads, best of %d\n",
+           LINES,
+           COMMANDS,
+           ARGS,
+           cpus,
+           ROUNDS);
+
+    double serial = benchSerial(spec, lines);
+    printf("%-24s %12s %12s %10s\n", "mode", "ms", "lines/s", "speedup");
+    printf("%-24s %12.2f %12.0f %10s\n",
+           "serial parse result",
+           serial / 1e6,
+           LINES / (serial / 1e9),
+           "-");
+
+    double base    = 0;
+    int    threads = 1;
+    for (; threads <= cpus; threads = nextThreads(threads, cpus)) {
+        int    failed  = 0;
+        double elapsed = benchBatch(spec, lines, results, threads, &failed);
+        if (threads == 1) {
+            base = elapsed;
+        }
+        char mode[32];
+        snprintf(mode, sizeof(mode), "batch %d threads", threads);
+        printf("%-24s %12.2f %12.0f %9.2fx\n",
+               mode,
+               elapsed / 1e6,
+               LINES / (elapsed / 1e9),
+               base / elapsed);
+        if (failed != LINES / 16) {
+            printf("unexpected failures: %d\n", failed);
+            return 1;
+        }
+    }
+
+    free(lines);
+    free(storage);
+    free(results);
+    argParseFree(spec);
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "ArgParse.h"
+#include "ArgParseTools.h"
+#include "benchTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TOKENS 1000000
+#define ROUNDS 5
+
+static const char *_LevelNames[] = {"scalar", "sse2", "avx2"};
+
+// 原先逐个参数调用的分类函数，作为对照
+static ArgType legacyCheckArgType(const char *arg) {
+    size_t len = strlen(arg);
+    if (len == 0) {
+        return BAD;
+    }
+    if (arg[0] == '-') {
+        if (len >= 2) {
+            return arg[1] == '-' ? LONG_ARG : SHORT_ARG;
+        }
+    } else {
+        return COMMAND;
+    }
+    return BAD;
+}
+
+// 逐字节同时求长度、哈希与'='位置的单次遍历，即向量扫描之前的分类方式
+static void bytewiseTokens(char *const *argv, ArgParseToken *tokens) {
+    for (int i = 0; i < TOKENS; i++) {
+        const unsigned char *p    = (const unsigned char *)argv[i];
+        unsigned int         hash = 2166136261u;
+        int                  eq   = -1;
+        while (*p != '\0') {
+            if (*p == '=' && eq < 0) {
+                eq = (int)(p - (const unsigned char *)argv[i]);
+            }
+            hash ^= *p++;
+            hash *= 16777619u;
+        }
+        tokens[i].len    = (unsigned int)(p - (const unsigned char *)argv[i]);
+        tokens[i].eq     = eq;
+        tokens[i].hash   = hash;
+        tokens[i].type   = legacyCheckArgType(argv[i]);
+        tokens[i].hashed = true;
+    }
+}
+
+/**
+ * @brief 生成类似xargs或@file展开后的参数列表，字符串连续存放
+ * 以值为主，夹杂长短选项、带'='的长选项与较长的路径
+ * @param width 值的基础宽度
+ * @param buffer 返回字符串缓冲区，由调用方释放
+ * @return 参数列表，由调用方释放
+ */
+static char **buildArgv(int width, char **buffer) {
+    char **argv   = malloc(TOKENS * sizeof(char *));
+    char  *cursor = malloc((size_t)TOKENS * (width + 48));
+    *buffer       = cursor;
+    for (int i = 0; i < TOKENS; i++) {
+        argv[i] = cursor;
+        switch (i % 16) {
+        case 0:
+            cursor += sprintf(cursor, "--option-%d=value-%d", i % 64, i);
+            break;
+        case 1:
+            cursor += sprintf(cursor, "-o%d", i % 8);
+            break;
+        case 2:
+            cursor += sprintf(
+                cursor, "/usr/share/data/%0*d/file.txt", width, i);
+            break;
+        default:
+            cursor += sprintf(cursor, "file-%0*d.txt", width, i);
+            break;
+        }
+        cursor++;
+    }
+    return argv;
+}
+
+static double benchLegacy(char **argv, ArgType *types) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        double start = benchNow();
+        for (int i = 0; i < TOKENS; i++) {
+            types[i] = legacyCheckArgType(argv[i]);
+        }
+        double elapsed = benchNow() - start;
+        if (round == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best / TOKENS;
+}
+
+static double benchBytewise(char **argv, ArgParseToken *tokens) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        double start = benchNow();
+        bytewiseTokens(argv, tokens);
+        double elapsed = benchNow() - start;
+        if (round == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best / TOKENS;
+}
+
+static double
+benchScan(ArgParseScanLevel level, char **argv, ArgParseToken *tokens) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        double start = benchNow();
+        argParseScanTokens(level, argv, TOKENS, tokens);
+        double elapsed = benchNow() - start;
+        if (round == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best / TOKENS;
+}
+
+// 各级别的结果必须与逐字节计算一致
+static int verify(char **argv, const ArgType *types, ArgParseToken *tokens) {
+    for (int i = 0; i < TOKENS; i++) {
+        const char *eq     = strchr(argv[i], '=');
+        int         expect = types[i] == LONG_ARG && eq ? eq - argv[i] : -1;
+        if (tokens[i].type != types[i] || tokens[i].len != strlen(argv[i]) ||
+            tokens[i].eq != expect) {
+            printf("mismatch at %d: %s\n", i, argv[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    ArgParseScanLevel top    = argParseScanLevel();
+    ArgType          *types  = malloc(TOKENS * sizeof(ArgType));
+    ArgParseToken    *tokens = malloc(TOKENS * sizeof(ArgParseToken));
+    int               failed = 0;
+
+    // 单位均为ns/token，speedup为最高级别相对逐字节遍历的倍数
+    printf("%6s %10s %10s", "width", "strlen", "bytewise");
+    for (int level = SCAN_SCALAR; level <= (int)top; level++) {
+        printf(" %10s", _LevelNames[level]);
+    }
+    printf(" %8s\n", "speedup");
+
+    int widths[] = {4, 16, 64, 256};
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+        char  *buffer = NULL;
+        char **list   = buildArgv(widths[w], &buffer);
+
+        double legacy   = benchLegacy(list, types);
+        double bytewise = benchBytewise(list, tokens);
+        double best     = 0;
+        failed |= verify(list, types, tokens);
+        printf("%6d %10.2f %10.2f", widths[w], legacy, bytewise);
+        for (int level = SCAN_SCALAR; level <= (int)top; level++) {
+            double ns = benchScan(level, list, tokens);
+            failed |= verify(list, types, tokens);
+            printf(" %10.2f", ns);
+            best = ns;
+        }
+        printf(" %7.2fx\n", bytewise / best);
+
+        free(list);
+        free(buffer);
+    }
+
+    free(types);
+    free(tokens);
+    return failed;
+}
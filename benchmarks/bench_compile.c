@@ -0,0 +1,85 @@
+#include "ArgParse.h"
+#include "ArgParseTools.h"
+#include "benchTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOOKUPS      1000000
+#define ARGS_PER_CMD 16
+
+static ArgParse *buildSpec(int width) {
+    ArgParse *argparse = argParseInit("compile bench", ArgParseNOVALUE);
+    char      name[32];
+    char      long_opt[32];
+
+    for (int i = 0; i < width; i++) {
+        snprintf(name, sizeof(name), "command-%d", i);
+        Command *command = argParseAddCommand(
+            argparse, name, "bench", NULL, NULL, NULL, ArgParseNOVALUE);
+        for (int j = 0; j < ARGS_PER_CMD; j++) {
+            snprintf(name, sizeof(name), "-o%d", j);
+            snprintf(long_opt, sizeof(long_opt), "--option-%d", j);
+            argParseAddArg(command,
+                           name,
+                           long_opt,
+                           "bench option",
+                           NULL,
+                           NULL,
+                           false,
+                           ArgParseSINGLEVALUE);
+        }
+    }
+    return argparse;
+}
+
+// 随机选取命令再查找其长选项，模拟解析时的两级查找
+static double benchLookup(ArgParse *argparse, char **names, char **opts) {
+    size_t found = 0;
+    double start = benchNow();
+    for (int i = 0; i < LOOKUPS; i++) {
+        Command *command = argParseFindCommand(argparse, names[i], NULL);
+        found += argParseFindCommandArgs(command, opts[i], NULL) != NULL;
+    }
+    double elapsed = benchNow() - start;
+    if (found != LOOKUPS) {
+        printf("lookup failed: %zu\n", found);
+    }
+    return elapsed / LOOKUPS;
+}
+
+int main(int argc, char *argv[]) {
+    // 查询串单独分配，避免与规格共用同一段内存
+    char **names = malloc(sizeof(char *) * LOOKUPS);
+    char **opts  = malloc(sizeof(char *) * LOOKUPS);
+    for (int i = 0; i < LOOKUPS; i++) {
+        names[i] = malloc(32);
+        opts[i]  = malloc(32);
+    }
+
+    printf("%8s %14s %14s\n", "commands", "tree(ns)", "compiled(ns)");
+    for (int width = 256; width <= 16384; width *= 4) {
+        ArgParse    *argparse = buildSpec(width);
+        unsigned int seed     = 1;
+        for (int i = 0; i < LOOKUPS; i++) {
+            seed = seed * 1103515245u + 12345u;
+            snprintf(names[i], 32, "command-%u", seed % width);
+            snprintf(opts[i], 32, "--option-%u", (seed >> 16) % ARGS_PER_CMD);
+        }
+
+        double tree = benchLookup(argparse, names, opts);
+        argParseCompile(argparse);
+        double compiled = benchLookup(argparse, names, opts);
+        printf("%8d %14.1f %14.1f\n", width, tree, compiled);
+
+        argParseFree(argparse);
+    }
+
+    for (int i = 0; i < LOOKUPS; i++) {
+        free(names[i]);
+        free(opts[i]);
+    }
+    free(names);
+    free(opts);
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "ArgParse.h"
+#include "ArgParseTools.h"
+#include "benchTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOOKUPS 1000000
+
+// 旧的线性扫描，作为对照
+static Command *linearFind(ArgParse *argParse, const char *name) {
+    for (int i = 0; i < argParse->commands_len; i++) {
+        if (strcmp(argParse->commands[i]->name, name) == 0) {
+            return argParse->commands[i];
+        }
+    }
+    return NULL;
+}
+
+static void benchWidth(int width) {
+    ArgParse *argparse = argParseInit("dispatch bench", ArgParseNOVALUE);
+    char    **names    = malloc(sizeof(char *) * width);
+    char      name[32];
+
+    for (int i = 0; i < width; i++) {
+        snprintf(name, sizeof(name), "command-%d", i);
+        argParseAddCommand(
+            argparse, name, "bench", NULL, NULL, NULL, ArgParseNOVALUE);
+        names[i] = argparse->commands[i]->name;
+    }
+
+    unsigned int seed  = 1;
+    size_t       found = 0;
+    double       start = benchNow();
+    for (int i = 0; i < LOOKUPS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        found +=
+            argParseFindCommand(argparse, names[seed % width], NULL) != NULL;
+    }
+    double indexed = (benchNow() - start) / LOOKUPS;
+
+    int linear_lookups = LOOKUPS / (width / 16 + 1);
+    start              = benchNow();
+    for (int i = 0; i < linear_lookups; i++) {
+        seed = seed * 1103515245u + 12345u;
+        found += linearFind(argparse, names[seed % width]) != NULL;
+    }
+    double linear = (benchNow() - start) / linear_lookups;
+
+    printf("%8d %14.1f %14.1f %10zu\n", width, indexed, linear, found);
+
+    free(names);
+    argParseFree(argparse);
+}
+
+// 三层命令树: 每层按名字分派一次
+static void benchTree(int width) {
+    ArgParse *argparse = argParseInit("dispatch bench", ArgParseNOVALUE);
+    char      name[32];
+
+    for (int i = 0; i < width; i++) {
+        snprintf(name, sizeof(name), "group-%d", i);
+        Command *group = argParseAddCommand(
+            argparse, name, "bench", NULL, NULL, NULL, ArgParseNOVALUE);
+        for (int j = 0; j < width; j++) {
+            snprintf(name, sizeof(name), "tool-%d", j);
+            Command *tool = argParseAddSubCommand(
+                group, name, "bench", NULL, NULL, NULL, ArgParseNOVALUE);
+            for (int k = 0; k < width; k++) {
+                snprintf(name, sizeof(name), "action-%d", k);
+                argParseAddSubCommand(
+                    tool, name, "bench", NULL, NULL, NULL, ArgParseNOVALUE);
+            }
+        }
+    }
+
+    char         path[3][32];
+    unsigned int seed  = 7;
+    size_t       found = 0;
+    double       total = 0;
+    for (int i = 0; i < LOOKUPS / 10; i++) {
+        seed = seed * 1103515245u + 12345u;
+        snprintf(path[0], sizeof(path[0]), "group-%u", seed % width);
+        snprintf(path[1], sizeof(path[1]), "tool-%u", (seed >> 8) % width);
+        snprintf(path[2], sizeof(path[2]), "action-%u", (seed >> 16) % width);
+
+        double   start   = benchNow();
+        Command *command = argParseFindCommand(argparse, path[0], NULL);
+        command          = argParseFindSubCommand(command, path[1], NULL);
+        command          = argParseFindSubCommand(command, path[2], NULL);
+        total += benchNow() - start;
+        found += command != NULL;
+    }
+
+    printf("%8d %8d %14.1f %10zu\n",
+           width,
+           width * width * width,
+           total / (LOOKUPS / 10),
+           found);
+
+    argParseFree(argparse);
+}
+
+int main(int argc, char *argv[]) {
+    printf("%8s %14s %14s %10s\n",
+           "commands",
+           "index(ns)",
+           "linear(ns)",
+           "found");
+    for (int width = 16; width <= 16384; width *= 4) {
+        benchWidth(width);
+    }
+
+    printf("\n%8s %8s %14s %10s\n",
+           "width",
+           "leaves",
+           "3-level(ns)",
+           "found");
+    for (int width = 4; width <= 32; width *= 2) {
+        benchTree(width);
+    }
+    return 0;
+}
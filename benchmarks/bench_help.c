@@ -0,0 +1,82 @@
+#include "ArgParse.h"
+#include "benchTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ROUNDS 5
+
+// 生成一个有options个选项的命令，以及同样数量的顶层命令
+static ArgParse *buildSpec(int options, Command **command) {
+    ArgParse *argparse = argParseInit("help bench", ArgParseNOVALUE);
+    char      short_opt[32];
+    char      long_opt[32];
+
+    *command = argParseAddCommand(argparse,
+                                  "fat",
+                                  "Command with many options",
+                                  NULL,
+                                  NULL,
+                                  NULL,
+                                  ArgParseNOVALUE);
+    for (int i = 0; i < options; i++) {
+        snprintf(short_opt, sizeof(short_opt), "-o%d", i);
+        snprintf(long_opt, sizeof(long_opt), "--option-%d", i);
+        argParseAddArg(*command,
+                       short_opt,
+                       long_opt,
+                       "A generated option with a reasonably long help line",
+                       NULL,
+                       NULL,
+                       false,
+                       ArgParseSINGLEVALUE);
+        snprintf(long_opt, sizeof(long_opt), "command-%d", i);
+        argParseAddCommand(argparse,
+                           long_opt,
+                           "A generated command with a help line",
+                           NULL,
+                           NULL,
+                           NULL,
+                           ArgParseNOVALUE);
+    }
+    return argparse;
+}
+
+int main(int argc, char *argv[]) {
+    printf("%8s %12s %12s %12s %12s\n",
+           "options",
+           "bytes",
+           "command(ms)",
+           "global(ms)",
+           "ns/byte");
+    for (int options = 625; options <= 20000; options *= 2) {
+        Command  *command  = NULL;
+        ArgParse *argparse = buildSpec(options, &command);
+        size_t    bytes    = 0;
+        double    cmd_time = 0;
+        double    top_time = 0;
+
+        for (int round = 0; round < ROUNDS; round++) {
+            double start = benchNow();
+            char  *help  = argParseGenerateHelpForCommand(command);
+            cmd_time += benchNow() - start;
+            bytes = strlen(help);
+            free(help);
+
+            start = benchNow();
+            help  = argParseGenerateHelp(argparse);
+            top_time += benchNow() - start;
+            bytes += strlen(help);
+            free(help);
+        }
+
+        printf("%8d %12zu %12.3f %12.3f %12.2f\n",
+               options,
+               bytes,
+               cmd_time / ROUNDS / 1e6,
+               top_time / ROUNDS / 1e6,
+               (cmd_time + top_time) / ROUNDS / bytes);
+        argParseFree(argparse);
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "ArgParse.h"
+#include "benchTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_VALUES 1000000
+#define ROUNDS     3
+
+static char *_argv[MAX_VALUES + 1];
+static char  _buffer[MAX_VALUES * 16];
+
+// 解析count个位置值，返回最好一轮的耗时(纳秒)
+static double parseValues(int count) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        ArgParse *argparse = argParseInit("bench", ArgParseMULTIVALUE);
+        double    start    = benchNow();
+        argParseParse(argparse, count + 1, _argv);
+        double elapsed = benchNow() - start;
+        argParseFree(argparse);
+        if (round == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    char *cursor = _buffer;
+    _argv[0]     = argv[0];
+    for (int i = 1; i <= MAX_VALUES; i++) {
+        _argv[i] = cursor;
+        cursor += sprintf(cursor, "file-%d", i - 1) + 1;
+    }
+
+    printf("%-12s %12s %12s\n", "values", "ms", "ns/value");
+    double base  = 0;
+    double large = 0;
+    for (int count = MAX_VALUES / 8; count <= MAX_VALUES; count *= 2) {
+        double elapsed = parseValues(count);
+        if (base == 0) {
+            base = elapsed;
+        }
+        large = elapsed;
+        printf("%-12d %12.2f %12.1f\n", count, elapsed / 1e6, elapsed / count);
+    }
+
+    // 线性时约为8倍，逐个realloc的二次复制会接近64倍
+    printf("ratio %d/%d: %.2f\n", MAX_VALUES, MAX_VALUES / 8, large / base);
+    return 0;
+}
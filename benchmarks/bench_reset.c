@@ -0,0 +1,95 @@
+#include "ArgParse.h"
+#include "benchTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PARSES   200000
+#define COMMANDS 64
+#define ARGS     8
+
+static ArgParse *buildSpec(void) {
+    ArgParse *argparse = argParseInit("reset bench", ArgParseNOVALUE);
+    char      name[32];
+    char      short_opt[8];
+    char      long_opt[32];
+
+    argParseAddGlobalArg(argparse,
+                         "-v",
+                         "--verbose",
+                         "verbose",
+                         NULL,
+                         NULL,
+                         false,
+                         ArgParseNOVALUE);
+    for (int i = 0; i < COMMANDS; i++) {
+        snprintf(name, sizeof(name), "command-%d", i);
+        Command *command = argParseAddCommand(
+            argparse, name, "bench", NULL, NULL, NULL, ArgParseNOVALUE);
+        for (int j = 0; j < ARGS; j++) {
+            snprintf(short_opt, sizeof(short_opt), "-%c", 'a' + j);
+            snprintf(long_opt, sizeof(long_opt), "--option-%d", j);
+            argParseAddArg(command,
+                           short_opt,
+                           long_opt,
+                           "bench option",
+                           NULL,
+                           NULL,
+                           false,
+                           j == 0 ? ArgParseMULTIVALUE : ArgParseSINGLEVALUE);
+        }
+    }
+    return argparse;
+}
+
+static char *_Argv[] = {"bench",
+                        "-v",
+                        "command-42",
+                        "--option-0",
+                        "a.txt",
+                        "b.txt",
+                        "c.txt",
+                        "d.txt",
+                        "-b",
+                        "value",
+                        "--option-5",
+                        "other"};
+static int   _Argc   = sizeof(_Argv) / sizeof(_Argv[0]);
+
+// 每次解析都重新构造并释放规格
+static double benchRebuild(void) {
+    double start = benchNow();
+    for (int i = 0; i < PARSES / 10; i++) {
+        ArgParse *argparse = buildSpec();
+        argParseParse(argparse, _Argc, _Argv);
+        argParseFree(argparse);
+    }
+    return (benchNow() - start) / (PARSES / 10);
+}
+
+// 同一规格反复解析，每次之间只做重置
+static double benchReset(bool borrow) {
+    ArgParse *argparse = buildSpec();
+    argParseSetBorrowValues(argparse, borrow);
+
+    double start = benchNow();
+    for (int i = 0; i < PARSES; i++) {
+        argParseReset(argparse);
+        argParseParse(argparse, _Argc, _Argv);
+    }
+    double elapsed = (benchNow() - start) / PARSES;
+
+    argParseFree(argparse);
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    double rebuild = benchRebuild();
+    double reset   = benchReset(false);
+    double borrow  = benchReset(true);
+
+    printf("%-16s %12s %14s\n", "mode", "ns/parse", "parses/s");
+    printf("%-16s %12.1f %14.0f\n", "rebuild", rebuild, 1e9 / rebuild);
+    printf("%-16s %12.1f %14.0f\n", "reset", reset, 1e9 / reset);
+    printf("%-16s %12.1f %14.0f\n", "reset+borrow", borrow, 1e9 / borrow);
+    return 0;
+}
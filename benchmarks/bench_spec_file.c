@@ -0,0 +1,75 @@
+#include "ArgParse.h"
+#include "benchTimer.h"
+#include <stdio.h>
+
+#define ARGS_PER_CMD 16
+#define ROUNDS       5
+#define SPEC_PATH    "CArgParseBench_spec.bin"
+
+static ArgParse *buildSpec(int width) {
+    ArgParse *argparse = argParseInit("spec file bench", ArgParseNOVALUE);
+    char      name[32];
+    char      long_opt[32];
+
+    for (int i = 0; i < width; i++) {
+        snprintf(name, sizeof(name), "command-%d", i);
+        Command *command = argParseAddCommand(
+            argparse, name, "bench", NULL, NULL, NULL, ArgParseNOVALUE);
+        for (int j = 0; j < ARGS_PER_CMD; j++) {
+            snprintf(name, sizeof(name), "-o%d", j);
+            snprintf(long_opt, sizeof(long_opt), "--option-%d", j);
+            argParseAddArg(command,
+                           name,
+                           long_opt,
+                           "bench option",
+                           NULL,
+                           NULL,
+                           false,
+                           ArgParseSINGLEVALUE);
+        }
+    }
+    return argparse;
+}
+
+// 启动到完成一次解析的耗时：构造并编译整棵树，或映射已保存的规格文件
+static double benchStartup(int width, bool load, char **argv) {
+    double best = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        double    start    = benchNow();
+        ArgParse *argparse = NULL;
+        if (load) {
+            argparse = argParseLoadSpec(SPEC_PATH);
+        } else {
+            argparse = buildSpec(width);
+            argParseCompile(argparse);
+        }
+        argParseParse(argparse, 3, argv);
+        double elapsed = benchNow() - start;
+        argParseFree(argparse);
+        if (round == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best / 1e3;
+}
+
+int main(int argc, char *argv[]) {
+    char *args[] = {argv[0], "command-1", "--option-3=x"};
+
+    printf(
+        "%8s %14s %14s %8s\n", "commands", "build(us)", "load(us)", "speedup");
+    for (int width = 256; width <= 16384; width *= 4) {
+        ArgParse *argparse = buildSpec(width);
+        if (!argParseSaveSpec(argparse, SPEC_PATH)) {
+            printf("save failed\n");
+            return 1;
+        }
+        argParseFree(argparse);
+
+        double build = benchStartup(width, false, args);
+        double load  = benchStartup(width, true, args);
+        printf("%8d %14.1f %14.1f %7.1fx\n", width, build, load, build / load);
+    }
+    remove(SPEC_PATH);
+    return 0;
+}
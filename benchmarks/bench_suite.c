@@ -0,0 +1,343 @@
+#include "ArgParse.h"
+#include "benchTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * 回归基准套件，每个用例输出一行JSON，便于逐次记录与比较:
+ * {"case":"wide","size":256,"argc":6,"startup_ns":...,"parse_ns":...,
+ *  "ns_per_token":...,"help_ns":...,"spec_allocs":...,"spec_bytes":...,
+ *  "allocs_per_parse":...,"parse_peak_bytes":...}
+ * startup_ns       从argParseInit构造规格、解析一次到argParseFree的总耗时
+ * parse_ns         同一规格argParseReset后再解析一次的耗时
+ * ns_per_token     parse_ns除以参数个数(不含程序名)
+ * help_ns          生成一次全局帮助信息的耗时
+ * spec_allocs      构造规格的分配次数，spec_bytes为构造后占用的字节数
+ * allocs_per_parse 重置后解析一次的分配次数，parse_peak_bytes为其间的峰值增量
+ * 计时与计数分开进行，计数分配器的头部不影响耗时
+ * 可用第一个参数只运行指定用例，例如: CArgParseBench deep
+ */
+
+#define MIN_TIME_NS 50e6 // 每项测量至少运行的时长
+#define MAX_ITERS   (1L << 24)
+
+typedef struct BenchCase {
+    const char *name;                    // 用例名
+    int         size;                    // 规模参数
+    ArgParse *(*build)(int size);        // 构造规格
+    char **(*args)(int size, int *argc); // 构造参数列表
+} BenchCase;
+
+typedef struct BenchCtx {
+    const BenchCase *bench;    // 当前用例
+    ArgParse        *argparse; // 预先构造的规格
+    int              argc;     // 参数个数
+    char           **argv;     // 参数列表
+} BenchCtx;
+
+typedef void (*BenchFn)(BenchCtx *ctx);
+
+// 生成格式化字符串，由调用方释放
+static char *benchFormat(const char *format, int i) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), format, i);
+    return strdup(buffer);
+}
+
+/** Start----------------规格生成---------------- */
+
+// 宽: size个命令，每个命令4个选项
+static ArgParse *buildWide(int size) {
+    ArgParse *argparse = argParseInit("wide bench", ArgParseNOVALUE);
+    char      name[32];
+    char      long_opt[32];
+
+    for (int i = 0; i < size; i++) {
+        snprintf(name, sizeof(name), "command-%d", i);
+        Command *command = argParseAddCommand(argparse,
+                                              name,
+                                              "Generated command",
+                                              NULL,
+                                              NULL,
+                                              NULL,
+                                              ArgParseNOVALUE);
+        for (int j = 0; j < 4; j++) {
+            snprintf(name, sizeof(name), "-%c", 'a' + j);
+            snprintf(long_opt, sizeof(long_opt), "--option-%d", j);
+            argParseAddArg(command,
+                           name,
+                           long_opt,
+                           "Generated option",
+                           NULL,
+                           NULL,
+                           false,
+                           ArgParseSINGLEVALUE);
+        }
+    }
+    return argparse;
+}
+
+// 深: 一条size层的子命令链，每层一个选项
+static ArgParse *buildDeep(int size) {
+    ArgParse *argparse = argParseInit("deep bench", ArgParseNOVALUE);
+    char      name[32];
+
+    Command *command = argParseAddCommand(argparse,
+                                          "level-0",
+                                          "Generated level",
+                                          NULL,
+                                          NULL,
+                                          NULL,
+                                          ArgParseNOVALUE);
+    for (int i = 1; i <= size; i++) {
+        argParseAddArg(command,
+                       "-o",
+                       "--option",
+                       "Generated option",
+                       NULL,
+                       NULL,
+                       false,
+                       ArgParseSINGLEVALUE);
+        if (i == size) {
+            break;
+        }
+        snprintf(name, sizeof(name), "level-%d", i);
+        command = argParseAddSubCommand(command,
+                                        name,
+                                        "Generated level",
+                                        NULL,
+                                        NULL,
+                                        NULL,
+                                        ArgParseNOVALUE);
+    }
+    return argparse;
+}
+
+// 胖: 一个命令带size个选项
+static ArgParse *buildFat(int size) {
+    ArgParse *argparse = argParseInit("fat bench", ArgParseNOVALUE);
+    char      short_opt[32];
+    char      long_opt[32];
+
+    Command *command = argParseAddCommand(argparse,
+                                          "run",
+                                          "Generated command",
+                                          NULL,
+                                          NULL,
+                                          NULL,
+                                          ArgParseNOVALUE);
+    for (int i = 0; i < size; i++) {
+        snprintf(short_opt, sizeof(short_opt), "-o%d", i);
+        snprintf(long_opt, sizeof(long_opt), "--option-%d", i);
+        argParseAddArg(command,
+                       short_opt,
+                       long_opt,
+                       "Generated option",
+                       NULL,
+                       NULL,
+                       false,
+                       ArgParseSINGLEVALUE);
+    }
+    return argparse;
+}
+
+// 多值: 一个多值选项，规格很小，规模体现在参数列表上
+static ArgParse *buildMulti(int size) {
+    ArgParse *argparse = argParseInit("multi bench", ArgParseNOVALUE);
+    Command  *command  = argParseAddCommand(argparse,
+                                          "add",
+                                          "Generated command",
+                                          NULL,
+                                          NULL,
+                                          NULL,
+                                          ArgParseNOVALUE);
+    argParseAddArg(command,
+                   "-f",
+                   "--file",
+                   "Generated files",
+                   NULL,
+                   NULL,
+                   false,
+                   ArgParseMULTIVALUE);
+    return argparse;
+}
+
+/** End----------------规格生成---------------- */
+
+/** Start----------------参数生成---------------- */
+
+// 宽: 选中间的命令并设置两个选项
+static char **argsWide(int size, int *argc) {
+    char **argv = malloc(6 * sizeof(char *));
+    argv[0]     = strdup("bench");
+    argv[1]     = benchFormat("command-%d", size / 2);
+    argv[2]     = strdup("-b");
+    argv[3]     = strdup("value");
+    argv[4]     = strdup("--option-3");
+    argv[5]     = strdup("value");
+    *argc       = 6;
+    return argv;
+}
+
+// 深: 沿子命令链走到最底层后设置选项
+static char **argsDeep(int size, int *argc) {
+    char **argv = malloc((size + 3) * sizeof(char *));
+    argv[0]     = strdup("bench");
+    for (int i = 0; i < size; i++) {
+        argv[i + 1] = benchFormat("level-%d", i);
+    }
+    argv[size + 1] = strdup("--option");
+    argv[size + 2] = strdup("value");
+    *argc          = size + 3;
+    return argv;
+}
+
+// 胖: 全部选项各设置一次，长短选项交替
+static char **argsFat(int size, int *argc) {
+    char **argv = malloc((size * 2 + 2) * sizeof(char *));
+    argv[0]     = strdup("bench");
+    argv[1]     = strdup("run");
+    for (int i = 0; i < size; i++) {
+        argv[i * 2 + 2] = benchFormat(i % 2 ? "--option-%d" : "-o%d", i);
+        argv[i * 2 + 3] = benchFormat("value-%d", i);
+    }
+    *argc = size * 2 + 2;
+    return argv;
+}
+
+// 多值: 一段长度为size的值
+static char **argsMulti(int size, int *argc) {
+    char **argv = malloc((size + 3) * sizeof(char *));
+    argv[0]     = strdup("bench");
+    argv[1]     = strdup("add");
+    argv[2]     = strdup("-f");
+    for (int i = 0; i < size; i++) {
+        argv[i + 3] = benchFormat("file-%d.txt", i);
+    }
+    *argc = size + 3;
+    return argv;
+}
+
+/** End----------------参数生成---------------- */
+
+/** Start----------------测量---------------- */
+
+static void runStartup(BenchCtx *ctx) {
+    ArgParse *argparse = ctx->bench->build(ctx->bench->size);
+    argParseParse(argparse, ctx->argc, ctx->argv);
+    argParseFree(argparse);
+}
+
+static void runParse(BenchCtx *ctx) {
+    argParseReset(ctx->argparse);
+    argParseParse(ctx->argparse, ctx->argc, ctx->argv);
+}
+
+static void runHelp(BenchCtx *ctx) {
+    free(argParseGenerateHelp(ctx->argparse));
+}
+
+/**
+ * @brief 反复运行fn直到总耗时超过MIN_TIME_NS，迭代次数按倍数增长
+ * @param fn 被测函数
+ * @param ctx 用例上下文
+ * @return 每次运行的平均纳秒数
+ */
+static double benchMeasure(BenchFn fn, BenchCtx *ctx) {
+    fn(ctx); // 预热，让值数组等可复用的内存先分配好
+    for (long iterations = 1;; iterations *= 2) {
+        double start = benchNow();
+        for (long i = 0; i < iterations; i++) {
+            fn(ctx);
+        }
+        double elapsed = benchNow() - start;
+        if (elapsed >= MIN_TIME_NS || iterations >= MAX_ITERS) {
+            return elapsed / iterations;
+        }
+    }
+}
+
+// 在计数分配器下分别统计构造规格与一次解析的分配
+static void benchCount(BenchCtx           *ctx,
+                       ArgParseAllocStats *spec,
+                       ArgParseAllocStats *parse) {
+    ArgParseAllocStats stats;
+    argParseUseCountingAllocator(&stats);
+
+    ArgParse *argparse = ctx->bench->build(ctx->bench->size);
+    *spec              = stats;
+    argParseParse(argparse, ctx->argc, ctx->argv); // 预热可复用的内存
+
+    argParseReset(argparse);
+    argParseAllocStatsBegin(&stats);
+    argParseParse(argparse, ctx->argc, ctx->argv);
+    *parse = stats;
+
+    argParseFree(argparse);
+    argParseUseCountingAllocator(NULL);
+}
+
+static void benchRun(const BenchCase *bench) {
+    BenchCtx ctx = {bench, NULL, 0, NULL};
+    ctx.argv     = bench->args(bench->size, &ctx.argc);
+
+    ArgParseAllocStats spec;
+    ArgParseAllocStats parse_stats;
+    benchCount(&ctx, &spec, &parse_stats);
+
+    ctx.argparse   = bench->build(bench->size);
+    double startup = benchMeasure(runStartup, &ctx);
+    double parse   = benchMeasure(runParse, &ctx);
+    double help    = benchMeasure(runHelp, &ctx);
+
+    printf("{\"case\":\"%s\",\"size\":%d,\"argc\":%d,"
+           "\"startup_ns\":%.1f,\"parse_ns\":%.1f,\"ns_per_token\":%.2f,"
+           "\"help_ns\":%.1f,\"spec_allocs\":%zu,\"spec_bytes\":%zu,"
+           "\"allocs_per_parse\":%zu,\"parse_peak_bytes\":%zu}\n",
+           bench->name,
+           bench->size,
+           ctx.argc,
+           startup,
+           parse,
+           parse / (ctx.argc - 1),
+           help,
+           spec.count,
+           spec.bytes,
+           parse_stats.count,
+           parse_stats.peak_bytes);
+    fflush(stdout);
+
+    argParseFree(ctx.argparse);
+    for (int i = 0; i < ctx.argc; i++) {
+        free(ctx.argv[i]);
+    }
+    free(ctx.argv);
+}
+
+/** End----------------测量---------------- */
+
+static const BenchCase _Cases[] = {
+    {"wide", 16, buildWide, argsWide},
+    {"wide", 256, buildWide, argsWide},
+    {"wide", 4096, buildWide, argsWide},
+    {"deep", 4, buildDeep, argsDeep},
+    {"deep", 32, buildDeep, argsDeep},
+    {"deep", 256, buildDeep, argsDeep},
+    {"fat", 16, buildFat, argsFat},
+    {"fat", 256, buildFat, argsFat},
+    {"fat", 4096, buildFat, argsFat},
+    {"multi", 1000, buildMulti, argsMulti},
+    {"multi", 100000, buildMulti, argsMulti},
+    {"multi", 1000000, buildMulti, argsMulti},
+};
+
+int main(int argc, char *argv[]) {
+    const char *only = argc > 1 ? argv[1] : NULL;
+    for (size_t i = 0; i < sizeof(_Cases) / sizeof(_Cases[0]); i++) {
+        if (only == NULL || strcmp(only, _Cases[i].name) == 0) {
+            benchRun(&_Cases[i]);
+        }
+    }
+    return 0;
+}
@@ -2,6 +2,8 @@
 #define CARGPARSE_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,32 +17,99 @@ extern "C" {
 
 #define ARG_DEFAULT_HELP_FLAG "--help"
 
-typedef struct ArgParse ArgParse; // 解析器
+typedef struct ArgParse       ArgParse;       // 解析器
+typedef struct ArgParseSpec   ArgParseSpec;   // 只读共享的解析规格，见argParseGetSpec
+typedef struct ArgParseArena  ArgParseArena;  // 内存池
+typedef struct ArgParseResult ArgParseResult; // 共享规格的解析结果
+struct Command;                                // 命令，定义见下文
+struct ArgParseIndex;                          // 名字到节点的索引，库内部使用
+struct ArgParseState;                          // 解析状态，库内部使用
 
 typedef int (*ArgParseCallback)(ArgParse *argParse,
                                 char    **val,
                                 int       val_len); // 回调函数
 
+typedef void (*ArgParseValueCallback)(ArgParse   *argParse,
+                                      const char *val,
+                                      void       *ctx); // 逐值回调函数
+
+typedef void (*ArgParseCommandBuilder)(struct Command *command,
+                                       void           *ctx); // 延迟构造回调函数
+
+typedef void *(*ArgParseMallocFn)(void *ctx, size_t size); // 分配函数
+typedef void *(*ArgParseReallocFn)(void  *ctx,
+                                   void  *ptr,
+                                   size_t size); // 重新分配函数
+typedef void (*ArgParseFreeFn)(void *ctx, void *ptr); // 释放函数
+
+typedef struct ArgParseAllocStats {
+    size_t count;      // 区间内的分配次数，重新分配也计一次
+    size_t bytes;      // 当前仍在使用的字节数
+    size_t base_bytes; // 区间开始时在使用的字节数
+    size_t peak_bytes; // 区间内在使用字节数相对base_bytes的峰值
+} ArgParseAllocStats; // 计数分配器的统计，见argParseUseCountingAllocator
+
 typedef enum {
     ArgParseNOVALUE = 0, // 无值
     ArgParseSINGLEVALUE, // 单值 例如： -i https://www.baidu.com
     ArgParseMULTIVALUE,  // 多值 例如: -s a b c 或 -s a -s b -s c等
 } ArgParseValueType;     // 值类型
 
+typedef enum {
+    ArgParseOK = 0,          // 解析成功
+    ArgParseHELP,            // 请求了帮助信息，例如: -h
+    ArgParseUNKNOWNCOMMAND,  // 未知命令或子命令
+    ArgParseUNKNOWNOPTION,   // 未知选项
+    ArgParseBADARGUMENT,     // 无法识别的参数，例如: 空字符串或单独的-
+    ArgParseINCOMPLETE,      // 子命令之后缺少选项
+    ArgParseMISSINGREQUIRED, // 必选参数未设置
+    ArgParseRESPONSEFILE,    // @file参数文件无法读取
+    ArgParseNOMEMORY,        // 解析时内存分配失败，与参数本身无关
+} ArgParseErrorKind;         // 错误类型
+
+typedef struct ArgParseErrorInfo {
+    ArgParseErrorKind     kind;    // 错误类型
+    int                   index;   // 出错参数在argv中的位置，无对应参数时为-1
+    const char           *token;   // 出错的参数或缺少的选项名，可能为NULL
+    const struct Command *command; // 出错时所在的命令，全局范围为NULL
+} ArgParseErrorInfo; // 结构化的解析错误，不持有任何内存
+
+typedef struct ArgParseArgv {
+    int    argc; // 参数个数
+    char **argv; // 参数列表
+} ArgParseArgv;  // 批量解析中的一条命令行
+
+typedef struct ArgParseStats {
+    /* 构造规格，argParseInit、argParseAdd*与argParseCompile累计 */
+    double spec_ns;     // 耗时(纳秒)
+    size_t spec_allocs; // 堆分配次数
+
+    /* 最近一次argParseParse */
+    size_t tokens;          // 参数分类次数
+    size_t lookups;         // 命令与选项查找次数
+    size_t compares;        // 名字的字符串比较次数
+    size_t options;         // 处理的选项个数
+    size_t required_checks; // 检查的必选参数个数
+    size_t parse_allocs;    // 堆分配次数
+    double expand_ns;       // @file展开耗时(纳秒)
+    double dispatch_ns;     // 分类、查找并保存参数值的耗时(纳秒)
+    double callback_ns;     // 命令回调耗时(纳秒)
+    double validate_ns;     // 必选参数检查耗时(纳秒)
+    double total_ns;        // 总耗时(纳秒)
+} ArgParseStats; // 解析统计，只在以ARGPARSE_STATS编译时收集
+
 typedef struct CommandArgs {
     /* 构造属性 */
-    char             *short_opt;   // 短选项名， 例如： -h
-    char             *long_opt;    // 长选项    例如： --help
-    char             *default_val; // 默认值
-    char             *help;        // 选项帮助信息
-    ArgParseCallback  callback;    // 回调函数
-    bool              required;    // 是否为必选参数
-    ArgParseValueType value_type;  // 值类型
-    /* 解析所用到的属性*/
-    char **val;        // 解析到的值
-    int    val_len;    // 解析到的值个数
-    bool   is_trigged; // 是否被触发
-} CommandArgs;
+    char                 *short_opt;      // 短选项名， 例如： -h
+    char                 *long_opt;       // 长选项    例如： --help
+    char                 *default_val;    // 默认值
+    char                 *help;           // 选项帮助信息
+    ArgParseCallback      callback;       // 回调函数
+    bool                  required;       // 是否为必选参数
+    ArgParseValueType     value_type;     // 值类型
+    ArgParseValueCallback value_callback; // 逐值回调，设置后值不再保存
+    void                 *value_ctx;      // 逐值回调的上下文
+} CommandArgs; // 解析结果保存在ArgParse的results中
 
 typedef struct CommandGroup {
     char            *name;         // 命令组名
@@ -51,40 +120,156 @@ typedef struct CommandGroup {
 
 typedef struct Command {
     /* 构造属性 */
-    char                *name;             // 命令名
-    char                *help;             // 命令帮助信息
-    CommandGroup        *group;            // 命令组
-    char                *default_val;      // 默认值
-    struct CommandArgs **args;             // 命令参数
-    int                  args_len;         // 命令参数个数
-    struct Command     **sub_commands;     // 子命令
-    int                  sub_commands_len; // 子命令个数
-    ArgParseCallback     callback;         // 回调函数
-    ArgParseValueType    value_type;       // 值类型
-
-    /* 解析所用到的属性*/
-    char **val;        // 解析到的值
-    int    val_len;    // 解析到的值个数
-    bool   is_trigged; // 是否被触发
-} Command;
+    struct ArgParse       *parser;             // 所属解析器
+    char                  *name;               // 命令名
+    char                  *help;               // 命令帮助信息
+    CommandGroup          *group;              // 命令组
+    char                  *default_val;        // 默认值
+    struct CommandArgs   **args;               // 命令参数
+    int                    args_len;           // 命令参数个数
+    struct ArgParseIndex  *args_index;         // 参数索引，长短选项名均可查
+    struct Command       **sub_commands;       // 子命令
+    int                    sub_commands_len;   // 子命令个数
+    struct ArgParseIndex  *sub_commands_index; // 子命令分派索引
+    ArgParseCallback       callback;           // 回调函数
+    ArgParseValueType      value_type;         // 值类型
+    ArgParseCommandBuilder builder;            // 延迟构造回调，可为NULL
+    void                  *builder_ctx;        // 延迟构造回调的上下文
+    int                    build_state; // 延迟构造状态，0表示已构造完成
+} Command; // 解析结果保存在ArgParse的results中
 
 typedef struct ArgParse {
     /* 构造属性 */
-    struct Command     **commands;        // 命令
-    int                  commands_len;    // 命令个数
-    struct CommandArgs **global_args;     // 全局参数
-    int                  global_args_len; // 全局参数个数
-    char                *documentation;   // 帮助文档
-    ArgParseValueType    value_type; // 值类型 程序默认需要的值例如 gcc main.c
+    struct Command      **commands;          // 命令
+    int                   commands_len;      // 命令个数
+    struct ArgParseIndex *commands_index;    // 命令分派索引
+    struct CommandArgs  **global_args;       // 全局参数
+    int                   global_args_len;   // 全局参数个数
+    struct ArgParseIndex *global_args_index; // 全局参数索引
+    char                 *documentation;     // 帮助文档
+    ArgParseValueType     value_type; // 值类型 程序默认需要的值例如 gcc main.c
+    ArgParseValueCallback value_callback; // 程序值的逐值回调
+    void                 *value_ctx;      // 程序值逐值回调的上下文
+    ArgParseArena        *arena;          // 内存池，为NULL时使用堆分配
+    bool                  borrow_values;  // 解析值是否直接借用argv
+    bool                  response_files; // 是否将@file参数展开为文件内容
+    bool                  static_spec;    // 是否为静态声明的规格
+    void                 *compiled;       // 编译生成的连续规格块或映射的规格文件
+    size_t                spec_file_size; // argParseLoadSpec映射的长度，否则为0
+    bool                  auto_help;      // 添加命令时是否自动添加帮助参数
+    bool                  color;          // 错误信息是否使用颜色
+    bool                  exit_on_error;  // 出错或请求帮助时是否打印并结束程序
 
     /* 解析所用到的属性*/
-    struct Command *current_command; // 当前解析到的命令
-    char          **val;
-    int             val_len;
-    int             argc; // 参数个数
-    char          **argv; // 参数列表
+    struct ArgParseState *state; // 解析结果与帮助缓存，静态规格在首次使用时分配
 } ArgParse;
 
+/** Start---------------静态规格---------------- */
+
+/*
+ * 以下宏在文件作用域中声明整棵命令树，节点、名字与节点数组均为只读常量，
+ * 程序启动时不做任何构造工作。宏参数顺序与对应的argParseAdd*函数一致，例如:
+ *
+ * static ArgParse parser = ARGPARSE_PARSER(
+ *     "示例程序",
+ *     ArgParseNOVALUE,
+ *     ARGPARSE_GLOBAL_ARGS(ARGPARSE_HELP_ARG),
+ *     ARGPARSE_COMMANDS(ARGPARSE_COMMAND(
+ *         "install", "安装", NULL, NULL, ArgParseNOVALUE,
+ *         ARGPARSE_ARGS(ARGPARSE_ARG("-i", "--index", "源地址", NULL, NULL,
+ *                                    false, ArgParseSINGLEVALUE)))));
+ *
+ * argParseParse(&parser, argc, argv);
+ * argParseFree(&parser); // 只释放解析结果，parser可再次用于解析
+ *
+ * parser的解析状态在第一次解析时分配，不能为const；多线程解析时以
+ * argParseGetSpec(&parser)取得规格后使用argParseParseResult。
+ * 静态规格没有名字索引，查找时按顺序比较；也不能再调用argParseAdd*修改。
+ * 命令很多时可用tools/ArgParseGen.c由规格文件生成同样的静态规格，
+ * 生成的规格带有完美哈希索引，每次查找只比较一个槽位
+ */
+
+#define ARGPARSE_ARG(short_opt_,                                               \
+                     long_opt_,                                                \
+                     help_,                                                    \
+                     default_val_,                                             \
+                     callback_,                                                \
+                     required_,                                                \
+                     value_type_)                                              \
+    ((CommandArgs *)&(const CommandArgs){                                      \
+        .short_opt   = (char *)(short_opt_),                                   \
+        .long_opt    = (char *)(long_opt_),                                    \
+        .default_val = (char *)(default_val_),                                 \
+        .help        = (char *)(help_),                                        \
+        .callback    = (callback_),                                            \
+        .required    = (required_),                                            \
+        .value_type  = (value_type_)})
+
+// 命令的参数列表，用于ARGPARSE_COMMAND的可变参数
+#define ARGPARSE_ARGS(...)                                                     \
+    .args     = (CommandArgs **)(CommandArgs *const[]){__VA_ARGS__},           \
+    .args_len = (int)(sizeof((CommandArgs *[]){__VA_ARGS__}) /                 \
+                      sizeof(CommandArgs *))
+
+// 命令的子命令列表，用于ARGPARSE_COMMAND的可变参数
+#define ARGPARSE_SUB_COMMANDS(...)                                             \
+    .sub_commands     = (Command **)(Command *const[]){__VA_ARGS__},           \
+    .sub_commands_len = (int)(sizeof((Command *[]){__VA_ARGS__}) /             \
+                              sizeof(Command *))
+
+// 可变参数可为ARGPARSE_ARGS、ARGPARSE_SUB_COMMANDS或.group等指定初始化项
+#define ARGPARSE_COMMAND(                                                      \
+    name_, help_, default_val_, callback_, value_type_, ...)                   \
+    ((Command *)&(const Command){.name        = (char *)(name_),               \
+                                 .help        = (char *)(help_),               \
+                                 .default_val = (char *)(default_val_),        \
+                                 .callback    = (callback_),                   \
+                                 .value_type  = (value_type_),                 \
+                                 __VA_ARGS__})
+
+// 解析器的命令列表，用于ARGPARSE_PARSER的可变参数
+#define ARGPARSE_COMMANDS(...)                                                 \
+    .commands     = (Command **)(Command *const[]){__VA_ARGS__},               \
+    .commands_len = (int)(sizeof((Command *[]){__VA_ARGS__}) /                 \
+                          sizeof(Command *))
+
+// 解析器的全局参数列表，用于ARGPARSE_PARSER的可变参数
+#define ARGPARSE_GLOBAL_ARGS(...)                                              \
+    .global_args     = (CommandArgs **)(CommandArgs *const[]){__VA_ARGS__},    \
+    .global_args_len = (int)(sizeof((CommandArgs *[]){__VA_ARGS__}) /          \
+                             sizeof(CommandArgs *))
+
+// 可变参数可为ARGPARSE_COMMANDS、ARGPARSE_GLOBAL_ARGS
+#define ARGPARSE_PARSER(documentation_, value_type_, ...)                      \
+    {.documentation = (char *)(documentation_),                                \
+     .value_type    = (value_type_),                                           \
+     .static_spec   = true,                                                    \
+     .color         = true,                                                    \
+     .exit_on_error = true,                                                    \
+     __VA_ARGS__}
+
+// 与argParseInit自动添加的全局帮助参数相同
+#define ARGPARSE_HELP_ARG                                                      \
+    ARGPARSE_ARG("-h",                                                         \
+                 "--help",                                                     \
+                 "show help",                                                  \
+                 NULL,                                                         \
+                 argParseHelpCallback,                                         \
+                 false,                                                        \
+                 ArgParseNOVALUE)
+
+// 与argParseAddCommand自动添加的命令帮助参数相同
+#define ARGPARSE_COMMAND_HELP_ARG                                              \
+    ARGPARSE_ARG("-h",                                                         \
+                 "--help",                                                     \
+                 "show help",                                                  \
+                 NULL,                                                         \
+                 argParseCommandHelpCallback,                                  \
+                 false,                                                        \
+                 ArgParseNOVALUE)
+
+/** End---------------静态规格---------------- */
+
 /** Start---------------构造API---------------- */
 
 /**
@@ -95,6 +280,17 @@ typedef struct ArgParse {
  */
 ArgParse *argParseInit(char *documentation, ArgParseValueType value_type);
 
+/**
+ * @brief 初始化使用内存池的解析器
+ * 命令、参数、字符串及解析到的值均从少量大块内存中顺序分配，
+ * argParseFree只需释放这些块，不再逐个节点释放
+ * @param documentation 帮助文档
+ * @param value_type 值类型,程序默认需要的值例如 gcc main.c
+ * @return ArgParse* 解析器指针
+ */
+ArgParse *argParseInitWithArena(char             *documentation,
+                                ArgParseValueType value_type);
+
 /**
  * @brief 释放解析器
  * @param argParse 解析器指针
@@ -142,6 +338,40 @@ Command *argParseAddSubCommand(Command          *Parent,
                                CommandGroup     *group,
                                ArgParseValueType value_type);
 
+/**
+ * @brief 添加延迟构造的命令，注册时只保存命令名、帮助信息与构造回调
+ * 解析时第一次分派到该命令、生成该命令的帮助信息或argParseCompile时才调用
+ * builder(command, ctx)添加参数与子命令，每个命令只调用一次。builder只应修改
+ * command自身：可以设置其callback与value_type，也可以继续添加延迟构造的子命令。
+ * argParseParseResult的多个线程同时分派到未构造的命令时只有一个线程执行builder
+ * @param argParse 解析器指针
+ * @param name 命令名
+ * @param help 命令帮助信息
+ * @param builder 构造回调
+ * @param ctx 构造回调的上下文
+ * @return Command* 命令指针
+ */
+Command *argParseAddLazyCommand(ArgParse              *argParse,
+                                const char            *name,
+                                const char            *help,
+                                ArgParseCommandBuilder builder,
+                                void                  *ctx);
+
+/**
+ * @brief 添加延迟构造的子命令，见argParseAddLazyCommand
+ * @param Parent 父命令指针
+ * @param name 命令名
+ * @param help 命令帮助信息
+ * @param builder 构造回调
+ * @param ctx 构造回调的上下文
+ * @return Command* 子命令指针
+ */
+Command *argParseAddLazySubCommand(Command               *Parent,
+                                   const char            *name,
+                                   const char            *help,
+                                   ArgParseCommandBuilder builder,
+                                   void                  *ctx);
+
 /**
  * @brief 添加命令参数
  * @param command 命令指针
@@ -183,10 +413,142 @@ CommandArgs *argParseAddGlobalArg(ArgParse         *argParse,
                                   ArgParseValueType value_type);
 
 /**
- * @brief 禁用自动生成帮助信息
+ * @brief 全局帮助参数回调，打印帮助信息后结束程序
+ * 关闭exit_on_error时只记录ArgParseHELP错误并返回
+ */
+int argParseHelpCallback(ArgParse *argParse, char **val, int val_len);
+
+/**
+ * @brief 命令帮助参数回调，打印当前命令的帮助信息后结束程序
+ * 关闭exit_on_error时只记录ArgParseHELP错误并返回
+ */
+int argParseCommandHelpCallback(ArgParse *argParse, char **val, int val_len);
+
+/**
+ * @brief 禁用自动生成帮助信息，只影响之后创建的解析器
  */
 void argParseDisableAutoHelp();
 
+/**
+ * @brief 设置库内全部堆内存使用的分配器，三个函数都为NULL时恢复malloc/realloc/free
+ * 规格、解析值、帮助信息等所有内存都经由这组函数分配与释放，
+ * 需在创建任何解析器之前调用，并保证其间分配的内存都已释放后才能再次更换。
+ * argParseGenerateHelp等返回的字符串也来自该分配器，需用free_fn释放
+ * @param malloc_fn 分配函数
+ * @param realloc_fn 重新分配函数，ptr为NULL时等同分配
+ * @param free_fn 释放函数
+ * @param ctx 原样传给三个函数的上下文
+ */
+void argParseSetAllocator(ArgParseMallocFn  malloc_fn,
+                          ArgParseReallocFn realloc_fn,
+                          ArgParseFreeFn    free_fn,
+                          void             *ctx);
+
+/**
+ * @brief 在当前分配器之上启用计数分配器，统计写入stats
+ * 每块内存前附加记录大小的头部，因此同样需在创建解析器之前调用；
+ * stats为NULL时停用。统计不加锁，只适合单线程测量
+ * @param stats 统计结果
+ */
+void argParseUseCountingAllocator(ArgParseAllocStats *stats);
+
+/**
+ * @brief 开始一个统计区间，清零分配次数与峰值，例如分别统计构造规格与每次解析
+ * @param stats 统计结果
+ */
+void argParseAllocStatsBegin(ArgParseAllocStats *stats);
+
+/**
+ * @brief 设置解析值的所有权模式，需在argParseParse之前调用
+ * 默认(false)时每个解析到的值都会复制一份，由解析器持有并在argParseFree时释放；
+ * 借用(true)时val中的指针直接指向argv[i]，解析器不复制也不释放，
+ * 调用方需保证argv在解析器使用期间一直有效
+ * @param argParse 解析器指针
+ * @param borrow 是否借用argv
+ */
+void argParseSetBorrowValues(ArgParse *argParse, bool borrow);
+
+/**
+ * @brief 设置是否展开@file参数，需在argParseParse之前调用
+ * 开启后argv中形如@path的参数会被替换为文件中的参数，参数之间以空白分隔，
+ * 可用单双引号包含空白，反斜杠转义下一个字符，文件中的@path会继续展开。
+ * 文件以内存映射方式读入并原地切分，借用模式下解析到的值直接指向映射，
+ * 映射在argParseFree或argParseReset时释放；不经argParseReset连续解析时
+ * 之前的值仍然有效，映射随之累积，反复解析的程序应在每次解析前调用argParseReset
+ * @param argParse 解析器指针
+ * @param enable 是否展开
+ */
+void argParseSetResponseFiles(ArgParse *argParse, bool enable);
+
+/**
+ * @brief 设置出错时是否结束程序，需在argParseParse之前调用
+ * 默认(true)时解析出错或遇到帮助选项会打印信息、释放解析器并结束程序；
+ * 关闭(false)后argParseParse不打印、不释放、不退出，出错路径也不分配内存，
+ * 只返回错误类型，详细信息由argParseGetError获取，适合嵌入长期运行的服务
+ * @param argParse 解析器指针
+ * @param enable 是否结束程序
+ */
+void argParseSetExitOnError(ArgParse *argParse, bool enable);
+
+/**
+ * @brief 设置程序值的逐值回调，需在argParseParse之前调用
+ * 设置后每识别到一个程序值就调用一次callback，值不再保存到解析器中，
+ * argParseGetVal与argParseGetValList将取不到值，内存占用与值的个数无关。
+ * val只在回调期间有效，需要保留时由回调自行复制
+ * @param argParse 解析器指针
+ * @param callback 逐值回调，为NULL时恢复保存值
+ * @param ctx 原样传给callback的上下文
+ */
+void argParseSetValueCallback(ArgParse             *argParse,
+                              ArgParseValueCallback callback,
+                              void                 *ctx);
+
+/**
+ * @brief 设置参数的逐值回调，语义与argParseSetValueCallback相同
+ * 设置后该参数的值不再保存，参数仍会被标记为触发，
+ * 参数自身的callback在全部值处理完后以空值列表调用
+ * @param argParse 参数所属的解析器
+ * @param arg 参数指针
+ * @param callback 逐值回调，为NULL时恢复保存值
+ * @param ctx 原样传给callback的上下文
+ * @return 静态声明的规格中参数只读，此时返回false
+ */
+bool argParseSetArgValueCallback(ArgParse             *argParse,
+                                 CommandArgs          *arg,
+                                 ArgParseValueCallback callback,
+                                 void                 *ctx);
+
+/**
+ * @brief 将构造完成的命令树冻结为一块连续内存，需在全部argParseAdd*之后、
+ * argParseParse之前调用。编译后命令、参数、索引与字符串都位于同一块内存中，
+ * 之前argParseAdd*返回的Command与CommandArgs指针失效，也不能再添加节点
+ * @param argParse 解析器指针
+ * @return 成功返回true，失败时命令树保持不变
+ */
+bool argParseCompile(ArgParse *argParse);
+
+/**
+ * @brief 把构造完成的命令树保存为与加载地址无关的二进制规格文件
+ * 文件中包含命令、命令组、参数、帮助信息与值类型，节点间的引用保存为文件内偏移，
+ * 文件头记录格式版本、平台布局与校验和。函数地址不能保存，只有自动添加的
+ * 帮助回调会在加载时恢复；命令或参数带有其他回调、逐值回调时不保存文件，
+ * 以免加载后回调静默失效。延迟构造的命令会先全部构造，构造回调不需要保存
+ * @param argParse 解析器指针
+ * @param path 文件路径
+ * @return 成功返回true，有不能保存的回调、静态规格、结果视图或写入失败返回false
+ */
+bool argParseSaveSpec(ArgParse *argParse, const char *path);
+
+/**
+ * @brief 映射argParseSaveSpec保存的规格文件，直接在映射上解析
+ * 加载时只把映射中的偏移换成地址，不重新构造节点与索引，
+ * 得到的规格与编译后的规格一样不能再添加节点，argParseFree时解除映射。
+ * 文件校验和只能发现损坏，不能防篡改，只应加载可信的文件
+ * @param path 文件路径
+ * @return 解析器指针，文件不存在、版本或平台布局不符、校验失败时返回NULL
+ */
+ArgParse *argParseLoadSpec(const char *path);
+
 /** End---------------构造API---------------- */
 
 /** Start----------------解析API---------------- */
@@ -196,8 +558,83 @@ void argParseDisableAutoHelp();
  * @param argParse 解析器指针
  * @param argc 参数个数
  * @param argv 参数列表
+ * @return 成功返回ArgParseOK，出错时(仅在关闭exit_on_error时返回)为错误类型
+ */
+ArgParseErrorKind argParseParse(ArgParse *argParse, int argc, char *argv[]);
+
+/**
+ * @brief 获取最近一次解析的错误
+ * token指向argv、@file映射或规格中的名字，在下一次解析或释放前有效
+ * @param argParse 解析器指针
+ * @return 错误信息，解析成功时kind为ArgParseOK
  */
-void argParseParse(ArgParse *argParse, int argc, char *argv[]);
+const ArgParseErrorInfo *argParseGetError(ArgParse *argParse);
+
+/**
+ * @brief 获取构造规格与最近一次解析的统计
+ * 统计只在定义ARGPARSE_STATS编译库时收集(cmake -DSTATS=ON)，
+ * 未定义时各统计点编译为空，不产生任何开销
+ * @param argParse 解析器指针
+ * @param stats 统计结果
+ * @return 收集了统计时返回true，否则stats清零并返回false
+ */
+bool argParseGetStats(ArgParse *argParse, ArgParseStats *stats);
+
+/**
+ * @brief 清除上一次解析的结果，之后可用同一解析器解析新的参数列表
+ * 命令树不会释放，值数组会保留并在下次解析时复用；
+ * 内存池模式下复制的值无法单独回收，反复解析时建议同时开启借用模式
+ * @param argParse 解析器指针
+ */
+void argParseReset(ArgParse *argParse);
+
+/**
+ * @brief 取得解析器的只读规格，供argParseParseResult与argParseParseBatch共享
+ * 规格与解析器是同一棵命令树，之后不能再调用argParseAdd*修改解析器；
+ * 解析器释放后规格失效。静态规格同样适用，例如argParseGetSpec(&parser)
+ * @param argParse 构造完成的解析器
+ * @return 解析规格，argParse为NULL时返回NULL
+ */
+const ArgParseSpec *argParseGetSpec(ArgParse *argParse);
+
+/**
+ * @brief 使用共享的规格解析命令行参数，结果保存在新建的ArgParseResult中
+ * 解析过程只读取spec，不修改它，多个线程可同时对同一spec调用本函数。
+ * 选项与命令的回调收到的是该结果私有的解析器视图，而不是原来的解析器，
+ * 视图只在回调期间有效；解析结束后用argParseResult*函数读取结果
+ * @param spec 解析规格
+ * @param argc 参数个数
+ * @param argv 参数列表
+ * @return 解析结果，内存分配失败返回NULL
+ */
+ArgParseResult *
+argParseParseResult(const ArgParseSpec *spec, int argc, char *argv[]);
+
+/**
+ * @brief 释放解析结果，不影响规格及其他结果
+ * @param result 解析结果
+ */
+void argParseResultFree(ArgParseResult *result);
+
+/**
+ * @brief 用多个线程对同一规格批量解析多条命令行，只保留每条的解析结论
+ * 每个线程只建立一个结果视图，逐条解析后重置复用，不为每条命令行重建解析器；
+ * 解析时不打印也不结束程序，值借用argv而不复制。spec的要求与
+ * argParseParseResult相同，选项与命令的回调会在工作线程中并发执行。
+ * results[i]为lines[i]的结论：成功时kind为ArgParseOK，command为最终解析到的
+ * 命令；出错时同argParseGetError，出错参数来自@file文件时token为NULL
+ * @param spec 解析规格
+ * @param lines 命令行数组，解析期间argv需保持有效
+ * @param count 命令行条数
+ * @param threads 线程数，不大于0时使用全部在线CPU；未启用线程支持时顺序解析
+ * @param results 结论数组，至少count个元素
+ * @return 解析失败的条数，参数无效时返回-1
+ */
+int argParseParseBatch(const ArgParseSpec *spec,
+                       const ArgParseArgv *lines,
+                       int                 count,
+                       int                 threads,
+                       ArgParseErrorInfo  *results);
 
 /**
  * @brief 获取当前解析到的命令名
@@ -284,6 +721,35 @@ bool argParseCheckGlobalTriggered(ArgParse *argParse, const char *opt);
 char  *argParseGetVal(ArgParse *argParse);
 char **argParseGetValList(ArgParse *argParse, int *len);
 
+/**
+ * @brief 以下函数读取argParseParseResult的结果，含义与同名的argParseGet*、
+ * argParseCheck*函数相同；返回的字符串与数组归结果所有，随结果一同释放
+ * @param result 解析结果
+ */
+const ArgParseErrorInfo *argParseResultGetError(const ArgParseResult *result);
+const Command *argParseResultGetCurCommand(const ArgParseResult *result);
+char          *argParseResultGetCurCommandName(const ArgParseResult *result);
+char          *argParseResultGetCurCommandValue(const ArgParseResult *result);
+char **argParseResultGetCurCommandValues(const ArgParseResult *result,
+                                         int                  *len);
+char  *argParseResultGetCurArg(const ArgParseResult *result, const char *opt);
+char **argParseResultGetCurArgList(const ArgParseResult *result,
+                                   const char           *opt,
+                                   int                  *len);
+char  *argParseResultGetGlobalArg(const ArgParseResult *result,
+                                  const char           *opt);
+char **argParseResultGetGlobalArgList(const ArgParseResult *result,
+                                      const char           *opt,
+                                      int                  *len);
+bool   argParseResultCheckCurArgTriggered(const ArgParseResult *result,
+                                          const char           *opt);
+bool   argParseResultCheckCommandTriggered(const ArgParseResult *result,
+                                           const char           *command_name);
+bool   argParseResultCheckGlobalTriggered(const ArgParseResult *result,
+                                          const char           *opt);
+char  *argParseResultGetVal(const ArgParseResult *result);
+char **argParseResultGetValList(const ArgParseResult *result, int *len);
+
 /** End----------------解析API---------------- */
 
 /**
@@ -300,6 +766,62 @@ char *argParseGenerateHelpForCommand(Command *command);
  */
 char *argParseGenerateHelp(ArgParse *argParse);
 
+/**
+ * @brief 获取缓存的帮助信息，每个命令的每种颜色变体最多生成一次
+ * 返回的缓冲区归解析器所有，不得修改或释放；添加命令或参数、编译规格
+ * 以及释放解析器后失效。回调收到的结果视图各自缓存
+ * @param argParse 解析器指针
+ * @param command 命令指针，为NULL时返回全局帮助信息
+ * @param color 是否包含颜色控制序列
+ * @param len 返回帮助信息长度，不含结尾'\0'，可为NULL
+ * @return 帮助信息，没有帮助文档或内存分配失败时为NULL
+ */
+const char *argParseGetHelp(ArgParse      *argParse,
+                            const Command *command,
+                            bool           color,
+                            size_t        *len);
+
+/**
+ * @brief 获取解析结果缓存的帮助信息，含义同argParseGetHelp
+ * 每个结果各自缓存，不写共享的规格；返回的缓冲区随结果一同释放
+ * @param result 解析结果
+ * @param command 命令指针，为NULL时返回全局帮助信息
+ * @param color 是否包含颜色控制序列
+ * @param len 返回帮助信息长度，不含结尾'\0'，可为NULL
+ * @return 帮助信息，没有帮助文档或内存分配失败时为NULL
+ */
+const char *argParseResultGetHelp(ArgParseResult *result,
+                                  const Command  *command,
+                                  bool            color,
+                                  size_t         *len);
+
+/**
+ * @brief 将帮助信息直接写入文件描述符，不生成中间字符串
+ * 已缓存时写出缓存，否则边生成边以writev分批写出，占用的内存与帮助信息长度无关
+ * @param argParse 解析器指针，command不为NULL时可为NULL
+ * @param command 命令指针，为NULL时写出全局帮助信息
+ * @param color 是否包含颜色控制序列
+ * @param fd 文件描述符
+ * @return 全部写出返回true，没有帮助文档或写入失败时返回false
+ */
+bool argParseWriteHelp(ArgParse      *argParse,
+                       const Command *command,
+                       bool           color,
+                       int            fd);
+
+/**
+ * @brief 将帮助信息写入stream，先刷新stream已缓冲的内容再写入其文件描述符
+ * @param argParse 解析器指针，command不为NULL时可为NULL
+ * @param command 命令指针，为NULL时写出全局帮助信息
+ * @param color 是否包含颜色控制序列
+ * @param stream 文件，例如stdout
+ * @return 全部写出返回true，没有帮助文档或写入失败时返回false
+ */
+bool argParsePrintHelp(ArgParse      *argParse,
+                       const Command *command,
+                       bool           color,
+                       FILE          *stream);
+
 /**
  * @brief 生成选项错误信息
  * @param argParse 解析器指针
@@ -3,6 +3,7 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -11,31 +12,200 @@
 #define BLUE  "\033[0;34m"
 #define RESET "\033[0m"
 
-static bool _AutoHelp = true; // 是否自动添加帮助信息
-static bool _COLOR    = true; // 是否启用颜色
+static bool _AutoHelp = true; // 新建解析器是否自动添加帮助信息
+
+static const ArgParseErrorInfo _NoError = {ArgParseOK, -1, NULL, NULL};
 
 void argParseDisableAutoHelp() { _AutoHelp = false; }
 
-ArgParse *argParseInit(char *documentation, ArgParseValueType value_type) {
-    ArgParse *argParse = malloc(sizeof(ArgParse));
+// 静态声明、已编译的规格以及结果视图都不能再添加节点
+static bool __specFrozen(ArgParse *argParse) {
+    return argParse->static_spec || argParse->compiled != NULL ||
+           argParse->state->is_result;
+}
+
+// 尚未解析过的静态规格没有解析状态，读取结果时读到这个空状态
+static const ArgParseState _EmptyState = {
+    .error = {ArgParseOK, -1, NULL, NULL}};
+
+static void __initState(ArgParseState *state, bool is_result) {
+    *state           = (ArgParseState){0};
+    state->is_result = is_result;
+    state->error     = _NoError;
+}
+
+// 读取解析结果所用的状态，不分配内存
+static const ArgParseState *__readState(const ArgParse *argParse) {
+    return argParse->state != NULL ? argParse->state : &_EmptyState;
+}
+
+/**
+ * @brief 取得可写的解析状态，静态规格的状态在第一次使用时分配
+ * 其他解析器与结果视图在创建时已带有状态
+ * @param argParse 解析器
+ * @return 解析状态，内存分配失败返回NULL
+ */
+static ArgParseState *__state(ArgParse *argParse) {
+    if (argParse->state == NULL) {
+        ArgParseState *state = argParseHeapAlloc(sizeof(ArgParseState));
+        if (state == NULL) {
+            return NULL;
+        }
+        __initState(state, false);
+        argParse->state = state;
+    }
+    return argParse->state;
+}
+
+enum {
+    COMMAND_BUILT    = 0, // 已构造完成，普通命令与静态命令始终为此状态
+    COMMAND_PENDING  = 1, // 尚未调用构造回调
+    COMMAND_BUILDING = 2, // 正在调用构造回调
+}; // 延迟构造命令的状态
+
+static int _BuildLock = 0; // 延迟构造命令时持有的锁，构造很少发生，全局共用一把
+
+// 当前线程是否正在执行构造回调，此时已持有构造锁
+static THREAD_LOCAL bool _InBuilder = false;
+
+// 丢弃已生成的帮助文本，规格变化后文本与以旧节点为键的条目都已失效
+static void __helpCacheClear(ArgParse *argParse) {
+    if (_InBuilder || argParse->state == NULL) {
+        // 构造回调只向尚未生成过帮助的命令添加节点，不必清空；
+        // 回调可能运行在共享规格的解析线程中，此时也不能写规格本身
+        return;
+    }
+    ArgParseHelpCache *cache = &argParse->state->help_cache;
+    for (int i = 0; i < cache->len; i++) {
+        argParseHeapFree(cache->entries[i].text[0]);
+        argParseHeapFree(cache->entries[i].text[1]);
+    }
+    argParseHeapFree(cache->entries);
+    *cache = (ArgParseHelpCache){NULL, 0, 0};
+}
+
+// 输出帮助信息，定义见帮助信息部分
+static void __writeHelp(ArgParse      *argParse,
+                        const Command *command,
+                        bool           color,
+                        TextSink      *out);
+
+void argParseSetBorrowValues(ArgParse *argParse, bool borrow) {
+    if (argParse == NULL) {
+        return;
+    }
+    argParse->borrow_values = borrow;
+}
+
+void argParseSetResponseFiles(ArgParse *argParse, bool enable) {
+    if (argParse == NULL) {
+        return;
+    }
+    argParse->response_files = enable;
+}
+
+void argParseSetExitOnError(ArgParse *argParse, bool enable) {
+    if (argParse == NULL) {
+        return;
+    }
+    argParse->exit_on_error = enable;
+}
+
+void argParseSetValueCallback(ArgParse             *argParse,
+                              ArgParseValueCallback callback,
+                              void                 *ctx) {
     if (argParse == NULL) {
+        return;
+    }
+    argParse->value_callback = callback;
+    argParse->value_ctx      = ctx;
+}
+
+bool argParseSetArgValueCallback(ArgParse             *argParse,
+                                 CommandArgs          *arg,
+                                 ArgParseValueCallback callback,
+                                 void                 *ctx) {
+    // 静态规格的节点位于只读段，不能写入
+    if (argParse == NULL || arg == NULL || argParse->static_spec) {
+        return false;
+    }
+    arg->value_callback = callback;
+    arg->value_ctx      = ctx;
+    return true;
+}
+
+typedef struct ParserBlock {
+    ArgParse      parser; // 解析器，state指向下面的状态
+    ArgParseState state;  // 解析器自身的解析状态
+} ParserBlock;            // 解析器与其解析状态一次分配
+
+// 分配解析器并初始化各字段，arena为NULL时使用堆分配
+static ArgParse *__argParseAlloc(ArgParseArena    *arena,
+                                 ArgParseValueType value_type) {
+    ParserBlock *block = arena != NULL
+                             ? argParseArenaAlloc(arena, sizeof(ParserBlock))
+                             : argParseMemAlloc(NULL, sizeof(ParserBlock));
+    if (block == NULL) {
         return NULL;
     }
 
-    argParse->commands        = NULL;
-    argParse->commands_len    = 0;
-    argParse->current_command = NULL;
-    argParse->global_args     = NULL;
-    argParse->global_args_len = 0;
-    argParse->argc            = 0;
-    argParse->argv            = NULL;
-    argParse->documentation   = stringNewCopy(documentation);
-    argParse->value_type      = value_type;
-    argParse->val             = NULL;
-    argParse->val_len         = 0;
+    ArgParse *argParse          = &block->parser;
+    argParse->arena             = arena;
+    argParse->borrow_values     = false;
+    argParse->response_files    = false;
+    argParse->static_spec       = false;
+    argParse->compiled          = NULL;
+    argParse->spec_file_size    = 0;
+    argParse->auto_help         = _AutoHelp;
+    argParse->color             = true;
+    argParse->commands          = NULL;
+    argParse->commands_len      = 0;
+    argParse->commands_index    = NULL;
+    argParse->global_args       = NULL;
+    argParse->global_args_len   = 0;
+    argParse->global_args_index = NULL;
+    argParse->documentation     = NULL;
+    argParse->value_type        = value_type;
+    argParse->value_callback    = NULL;
+    argParse->value_ctx         = NULL;
+    argParse->exit_on_error     = true;
+    argParse->state             = &block->state;
+    __initState(argParse->state, false);
+    argParse->state->stats.spec_allocs = 1; // 解析器本身或其所在的区块
+    return argParse;
+}
+
+// 初始化解析器，arena为NULL时使用堆分配
+static ArgParse *__argParseInit(ArgParseArena    *arena,
+                                char             *documentation,
+                                ArgParseValueType value_type) {
+    ArgParse *argParse = __argParseAlloc(arena, value_type);
+    if (argParse == NULL) {
+        return NULL;
+    }
 
+    SPEC_BEGIN(argParse);
+    argParse->documentation = argParseMemStrCopy(argParse, documentation);
     argParseAutoHelp(argParse);
+    SPEC_END();
+
+    return argParse;
+}
 
+ArgParse *argParseInit(char *documentation, ArgParseValueType value_type) {
+    return __argParseInit(NULL, documentation, value_type);
+}
+
+ArgParse *argParseInitWithArena(char             *documentation,
+                                ArgParseValueType value_type) {
+    ArgParseArena *arena = argParseArenaCreate();
+    if (arena == NULL) {
+        return NULL;
+    }
+    ArgParse *argParse = __argParseInit(arena, documentation, value_type);
+    if (argParse == NULL) {
+        argParseArenaDestroy(arena);
+    }
     return argParse;
 }
 
@@ -44,15 +214,22 @@ ArgParse *argParseInit(char *documentation, ArgParseValueType value_type) {
  * @param argParse ArgParse结构体指针
  * @param val 参数值
  * @param val_len 参数值长度
- * @return 无返回值，将直接结束程序
+ * @return 默认直接结束程序，关闭exit_on_error时记录帮助请求后返回0
  */
-NORETURN int __helpCallback(ArgParse *argParse, char **val, int val_len) {
+int argParseHelpCallback(ArgParse *argParse, char **val, int val_len) {
     if (argParse == NULL) {
         exit(1);
     }
-    char *help_doc = argParseGenerateHelp(argParse);
-    printf("%s\n", help_doc);
-    free(help_doc);
+    if (!argParse->exit_on_error) {
+        argParse->state->error =
+            (ArgParseErrorInfo){ArgParseHELP, -1, NULL, NULL};
+        return 0;
+    }
+    TextSink out;
+    textSinkInitFile(&out, stdout);
+    __writeHelp(argParse, NULL, argParse->color, &out);
+    textSinkAppend(&out, 1, "\n");
+    textSinkFlush(&out);
     argParseFree(argParse);
     exit(0);
 }
@@ -62,10 +239,10 @@ NORETURN int __helpCallback(ArgParse *argParse, char **val, int val_len) {
  * @param argParse ArgParse结构体指针
  */
 void argParseAutoHelp(ArgParse *argParse) {
-    if (!_AutoHelp) {
+    if (argParse == NULL) {
         return;
     }
-    if (argParse == NULL) {
+    if (!argParse->auto_help) {
         return;
     }
 
@@ -74,27 +251,34 @@ void argParseAutoHelp(ArgParse *argParse) {
                          "--help",
                          "show help",
                          NULL,
-                         __helpCallback,
+                         argParseHelpCallback,
                          false,
                          ArgParseNOVALUE);
 }
 
-int __commandHelpCallback(ArgParse *argParse, char **val, int val_len) {
+int argParseCommandHelpCallback(ArgParse *argParse, char **val, int val_len) {
     if (argParse == NULL) {
         return -1;
     }
-    char *help_doc = argParseGenerateHelpForCommand(argParse->current_command);
-    printf("%s", help_doc);
-    free(help_doc);
+    ArgParseState *state = argParse->state;
+    if (!argParse->exit_on_error) {
+        state->error = (ArgParseErrorInfo){
+            ArgParseHELP, -1, NULL, state->current_command};
+        return 0;
+    }
+    TextSink out;
+    textSinkInitFile(&out, stdout);
+    __writeHelp(argParse, state->current_command, argParse->color, &out);
+    textSinkFlush(&out);
     exit(0);
     return 0;
 }
 
 void argParseCommandAutoHelp(Command *command) {
-    if (!_AutoHelp) {
+    if (command == NULL || command->parser == NULL) {
         return;
     }
-    if (command == NULL) {
+    if (!command->parser->auto_help) {
         return;
     }
 
@@ -103,37 +287,138 @@ void argParseCommandAutoHelp(Command *command) {
                    "--help",
                    "show help",
                    NULL,
-                   __commandHelpCallback,
+                   argParseCommandHelpCallback,
                    false,
                    ArgParseNOVALUE);
 }
 
-Command *argParseAddCommand(ArgParse         *argParse,
-                            const char       *name,
-                            const char       *help,
-                            const char       *default_val,
-                            ArgParseCallback  callback,
-                            CommandGroup     *group,
-                            ArgParseValueType value_type) {
+/**
+ * @brief 确保延迟构造的命令已调用过构造回调
+ * 已构造时只有一次acquire读取；否则持有构造锁后再次检查，
+ * 保证共享规格的多个解析线程中只有一个执行回调，其余线程等待其完成。
+ * 回调中再次构造其他命令时已持有锁，直接构造；构造自身时不做任何事
+ * @param command 命令指针
+ */
+static void __buildCommand(Command *command) {
+    if (command == NULL ||
+        argParseAtomicLoad(&command->build_state) == COMMAND_BUILT) {
+        return;
+    }
+
+    bool nested = _InBuilder;
+    if (!nested) {
+        argParseSpinLock(&_BuildLock);
+    }
+    if (argParseAtomicLoad(&command->build_state) == COMMAND_PENDING) {
+        argParseAtomicStore(&command->build_state, COMMAND_BUILDING);
+        _InBuilder = true;
+        // 与普通命令一致，帮助参数排在最前
+        argParseCommandAutoHelp(command);
+        command->builder(command, command->builder_ctx);
+        _InBuilder = nested;
+        argParseAtomicStore(&command->build_state, COMMAND_BUILT);
+    }
+    if (!nested) {
+        argParseSpinUnlock(&_BuildLock);
+    }
+}
+
+// 构造一组命令及其全部子命令
+static void __buildAll(Command **commands, int len) {
+    for (int i = 0; i < len; i++) {
+        __buildCommand(commands[i]);
+        __buildAll(commands[i]->sub_commands, commands[i]->sub_commands_len);
+    }
+}
+
+// 设置延迟构造回调；普通命令立即添加帮助参数，延迟构造的命令在构造时添加
+static void
+__initBuild(Command *command, ArgParseCommandBuilder builder, void *ctx) {
+    command->builder     = builder;
+    command->builder_ctx = ctx;
+    if (builder != NULL) {
+        command->build_state = COMMAND_PENDING;
+    } else {
+        argParseCommandAutoHelp(command);
+    }
+}
 
-    if (argParse == NULL || name == NULL) {
+static Command *__argParseAddCommand(ArgParse              *argParse,
+                                     const char            *name,
+                                     const char            *help,
+                                     const char            *default_val,
+                                     ArgParseCallback       callback,
+                                     CommandGroup          *group,
+                                     ArgParseValueType      value_type,
+                                     ArgParseCommandBuilder builder,
+                                     void                  *ctx) {
+
+    if (argParse == NULL || name == NULL || __specFrozen(argParse)) {
         return NULL;
     }
+    __helpCacheClear(argParse);
     // 构造命令结构
-    Command *command =
-        createCommand(name, help, default_val, callback, group, value_type);
+    Command *command = createCommand(
+        argParse, name, help, default_val, callback, group, value_type);
+    if (command == NULL) {
+        return NULL;
+    }
 
     // 将命令结构添加到argParse中
-    argParse->commands = realloc(
-        argParse->commands, sizeof(Command *) * (argParse->commands_len + 1));
-    if (argParse->commands == NULL) {
+    Command **commands = argParseMemGrow(argParse,
+                                         argParse->commands,
+                                         argParse->commands_len,
+                                         sizeof(Command *));
+    if (commands == NULL) {
         return NULL;
     }
+    argParse->commands                         = commands;
     argParse->commands[argParse->commands_len] = command;
     argParse->commands_len++;
 
-    argParseCommandAutoHelp(command);
+    if (!argParseIndexInsert(
+            argParse, &argParse->commands_index, command->name, command)) {
+        return NULL;
+    }
+
+    __initBuild(command, builder, ctx);
+
+    return command;
+}
+
+Command *argParseAddCommand(ArgParse         *argParse,
+                            const char       *name,
+                            const char       *help,
+                            const char       *default_val,
+                            ArgParseCallback  callback,
+                            CommandGroup     *group,
+                            ArgParseValueType value_type) {
+    SPEC_BEGIN(argParse);
+    Command *command = __argParseAddCommand(argParse,
+                                            name,
+                                            help,
+                                            default_val,
+                                            callback,
+                                            group,
+                                            value_type,
+                                            NULL,
+                                            NULL);
+    SPEC_END();
+    return command;
+}
 
+Command *argParseAddLazyCommand(ArgParse              *argParse,
+                                const char            *name,
+                                const char            *help,
+                                ArgParseCommandBuilder builder,
+                                void                  *ctx) {
+    if (builder == NULL) {
+        return NULL;
+    }
+    SPEC_BEGIN(argParse);
+    Command *command = __argParseAddCommand(
+        argParse, name, help, NULL, NULL, NULL, ArgParseNOVALUE, builder, ctx);
+    SPEC_END();
     return command;
 }
 
@@ -145,8 +430,54 @@ Command *argParseAddCommand(ArgParse         *argParse,
  * @param callback 子命令回调函数
  * @param group 子命令组
  * @param value_type 子命令值类型
+ * @param builder 延迟构造回调，为NULL时为普通子命令
+ * @param ctx 延迟构造回调的上下文
  * @return
  */
+static Command *__argParseAddSubCommand(Command               *Parent,
+                                        const char            *name,
+                                        const char            *help,
+                                        const char            *default_val,
+                                        ArgParseCallback       callback,
+                                        CommandGroup          *group,
+                                        ArgParseValueType      value_type,
+                                        ArgParseCommandBuilder builder,
+                                        void                  *ctx) {
+
+    // 静态声明的命令没有所属解析器，不能再添加子命令
+    if (Parent == NULL || name == NULL || Parent->parser == NULL ||
+        __specFrozen(Parent->parser)) {
+        return NULL;
+    }
+    __helpCacheClear(Parent->parser);
+    // 构造命令结构
+    ArgParse *argParse = Parent->parser;
+    Command  *command  = createCommand(
+        argParse, name, help, default_val, callback, group, value_type);
+    if (command == NULL) {
+        return NULL;
+    }
+    // 将命令结构添加到Parent中
+    Command **sub_commands = argParseMemGrow(argParse,
+                                             Parent->sub_commands,
+                                             Parent->sub_commands_len,
+                                             sizeof(Command *));
+    if (sub_commands == NULL)
+        return NULL;
+    Parent->sub_commands                           = sub_commands;
+    Parent->sub_commands[Parent->sub_commands_len] = command;
+    Parent->sub_commands_len++;
+
+    if (!argParseIndexInsert(
+            argParse, &Parent->sub_commands_index, command->name, command)) {
+        return NULL;
+    }
+
+    __initBuild(command, builder, ctx);
+
+    return command;
+}
+
 Command *argParseAddSubCommand(Command          *Parent,
                                const char       *name,
                                const char       *help,
@@ -154,28 +485,85 @@ Command *argParseAddSubCommand(Command          *Parent,
                                ArgParseCallback  callback,
                                CommandGroup     *group,
                                ArgParseValueType value_type) {
+    SPEC_BEGIN(Parent != NULL ? Parent->parser : NULL);
+    Command *command = __argParseAddSubCommand(Parent,
+                                               name,
+                                               help,
+                                               default_val,
+                                               callback,
+                                               group,
+                                               value_type,
+                                               NULL,
+                                               NULL);
+    SPEC_END();
+    return command;
+}
 
-    if (Parent == NULL || name == NULL) {
+Command *argParseAddLazySubCommand(Command               *Parent,
+                                   const char            *name,
+                                   const char            *help,
+                                   ArgParseCommandBuilder builder,
+                                   void                  *ctx) {
+    if (builder == NULL) {
         return NULL;
     }
-    // 构造命令结构
-    Command *command =
-        createCommand(name, help, default_val, callback, group, value_type);
-    if (command == NULL) {
+    SPEC_BEGIN(Parent != NULL ? Parent->parser : NULL);
+    Command *command = __argParseAddSubCommand(
+        Parent, name, help, NULL, NULL, NULL, ArgParseNOVALUE, builder, ctx);
+    SPEC_END();
+    return command;
+}
+
+static CommandArgs *__argParseAddArg(Command          *command,
+                                     const char       *short_opt,
+                                     const char       *long_opt,
+                                     const char       *help,
+                                     const char       *default_val,
+                                     ArgParseCallback  callback,
+                                     bool              required,
+                                     ArgParseValueType value_type) {
+
+    if (command == NULL || command->parser == NULL ||
+        __specFrozen(command->parser)) {
         return NULL;
     }
-    // 将命令结构添加到Parent中
-    Parent->sub_commands =
-        realloc(Parent->sub_commands,
-                sizeof(Command *) * (Parent->sub_commands_len + 1));
-    if (Parent->sub_commands == NULL)
+    __helpCacheClear(command->parser);
+    // 构造参数结构
+    ArgParse    *argParse = command->parser;
+    CommandArgs *arg      = createCommandArgs(argParse,
+                                         short_opt,
+                                         long_opt,
+                                         default_val,
+                                         help,
+                                         callback,
+                                         required,
+                                         value_type);
+    if (arg == NULL) {
         return NULL;
-    Parent->sub_commands[Parent->sub_commands_len] = command;
-    Parent->sub_commands_len++;
+    }
+    // 将参数结构添加到command中
+    CommandArgs **args = argParseMemGrow(
+        argParse, command->args, command->args_len, sizeof(CommandArgs *));
+    if (args == NULL) {
+        return NULL;
+    }
+    command->args                    = args;
+    command->args[command->args_len] = arg;
+    command->args_len++;
 
-    argParseCommandAutoHelp(command);
+    // 长短选项名指向同一参数，查找时任意形式只需一次探测
+    if (arg->short_opt != NULL &&
+        !argParseIndexInsert(
+            argParse, &command->args_index, arg->short_opt, arg)) {
+        return NULL;
+    }
+    if (arg->long_opt != NULL &&
+        !argParseIndexInsert(
+            argParse, &command->args_index, arg->long_opt, arg)) {
+        return NULL;
+    }
 
-    return command;
+    return arg;
 }
 
 CommandArgs *argParseAddArg(Command          *command,
@@ -186,24 +574,66 @@ CommandArgs *argParseAddArg(Command          *command,
                             ArgParseCallback  callback,
                             bool              required,
                             ArgParseValueType value_type) {
+    SPEC_BEGIN(command != NULL ? command->parser : NULL);
+    CommandArgs *arg = __argParseAddArg(command,
+                                        short_opt,
+                                        long_opt,
+                                        help,
+                                        default_val,
+                                        callback,
+                                        required,
+                                        value_type);
+    SPEC_END();
+    return arg;
+}
 
-    if (command == NULL) {
+static CommandArgs *__argParseAddGlobalArg(ArgParse         *argParse,
+                                           const char       *short_opt,
+                                           const char       *long_opt,
+                                           const char       *help,
+                                           const char       *default_val,
+                                           ArgParseCallback  callback,
+                                           bool              required,
+                                           ArgParseValueType value_type) {
+
+    if (argParse == NULL || __specFrozen(argParse)) {
         return NULL;
     }
+    __helpCacheClear(argParse);
     // 构造参数结构
-    CommandArgs *arg = createCommandArgs(
-        short_opt, long_opt, default_val, help, callback, required, value_type);
+    CommandArgs *arg = createCommandArgs(argParse,
+                                         short_opt,
+                                         long_opt,
+                                         default_val,
+                                         help,
+                                         callback,
+                                         required,
+                                         value_type);
     if (arg == NULL) {
         return NULL;
     }
-    // 将参数结构添加到command中
-    command->args =
-        realloc(command->args, sizeof(CommandArgs *) * (command->args_len + 1));
-    if (command->args == NULL) {
+    // 将参数结构添加到argParse中
+    CommandArgs **global_args = argParseMemGrow(argParse,
+                                                argParse->global_args,
+                                                argParse->global_args_len,
+                                                sizeof(CommandArgs *));
+    if (global_args == NULL) {
+        return NULL;
+    }
+    argParse->global_args                            = global_args;
+    argParse->global_args[argParse->global_args_len] = arg;
+    argParse->global_args_len++;
+
+    if (arg->short_opt != NULL &&
+        !argParseIndexInsert(
+            argParse, &argParse->global_args_index, arg->short_opt, arg)) {
+        return NULL;
+    }
+    if (arg->long_opt != NULL &&
+        !argParseIndexInsert(
+            argParse, &argParse->global_args_index, arg->long_opt, arg)) {
         return NULL;
     }
-    command->args[command->args_len] = arg;
-    command->args_len++;
 
     return arg;
 }
@@ -216,135 +646,1600 @@ CommandArgs *argParseAddGlobalArg(ArgParse         *argParse,
                                   ArgParseCallback  callback,
                                   bool              required,
                                   ArgParseValueType value_type) {
-
-    if (argParse == NULL) {
-        return NULL;
-    }
-    // 构造参数结构
-    CommandArgs *arg = createCommandArgs(
-        short_opt, long_opt, default_val, help, callback, required, value_type);
-    if (arg == NULL) {
-        return NULL;
-    }
-    // 将参数结构添加到argParse中
-    argParse->global_args =
-        realloc(argParse->global_args,
-                sizeof(CommandArgs *) * (argParse->global_args_len + 1));
-    if (argParse->global_args == NULL) {
-        return NULL;
-    }
-    argParse->global_args[argParse->global_args_len] = arg;
-    argParse->global_args_len++;
-
+    SPEC_BEGIN(argParse);
+    CommandArgs *arg = __argParseAddGlobalArg(argParse,
+                                              short_opt,
+                                              long_opt,
+                                              help,
+                                              default_val,
+                                              callback,
+                                              required,
+                                              value_type);
+    SPEC_END();
     return arg;
 }
 
 /** Start----------------内存释放API---------------- */
-void __freeCommandArgs(CommandArgs *arg) {
+// 释放解析到的值，借用模式下值属于argv，只释放数组本身
+static void __freeValues(ArgParse *argParse, char **val, int val_len) {
+    if (!argParse->borrow_values) {
+        for (int i = 0; i < val_len; i++) {
+            argParseMemFree(argParse, val[i]);
+        }
+    }
+    argParseMemFree(argParse, val);
+}
+
+void __freeCommandArgs(ArgParse *argParse, CommandArgs *arg) {
     if (arg == NULL) {
         return;
     }
 
-    free(arg->short_opt);
-    free(arg->long_opt);
-    free(arg->help);
-    free(arg->default_val);
-    for (size_t i = 0; i < arg->val_len; i++) {
-        free(arg->val[i]);
-    }
-    free(arg->val);
-    free(arg);
+    argParseHeapFree(arg->short_opt);
+    argParseHeapFree(arg->long_opt);
+    argParseHeapFree(arg->help);
+    argParseHeapFree(arg->default_val);
+    argParseHeapFree(arg);
 }
 
-void __freeCommand(Command *command) {
+void __freeCommand(ArgParse *argParse, Command *command) {
     if (command == NULL) {
         return;
     }
 
     for (size_t i = 0; i < command->args_len; i++) {
-        __freeCommandArgs(command->args[i]);
+        __freeCommandArgs(argParse, command->args[i]);
     }
 
     for (size_t i = 0; i < command->sub_commands_len; i++) {
-        __freeCommand(command->sub_commands[i]);
+        __freeCommand(argParse, command->sub_commands[i]);
     }
-    free(command->sub_commands);
-    free(command->name);
-    free(command->help);
-    free(command->args);
-    free(command->default_val);
 
-    if (command->val_len > 0) {
-        for (size_t i = 0; i < command->val_len; i++) {
-            free(command->val[i]);
-        }
-        free(command->val);
-    }
+    argParseHeapFree(command->sub_commands);
+    argParseIndexFree(argParse, &command->sub_commands_index);
+    argParseHeapFree(command->name);
+    argParseHeapFree(command->help);
+    argParseHeapFree(command->args);
+    argParseIndexFree(argParse, &command->args_index);
+    argParseHeapFree(command->default_val);
 
-    free(command);
+    argParseHeapFree(command);
 }
 
-void argParseFree(ArgParse *argParse) {
+// 释放整棵命令树，不包括解析器本身；静态或已编译规格的节点不单独分配
+static void __freeTree(ArgParse *argParse) {
+    if (__specFrozen(argParse)) {
+        return;
+    }
+
     // 释放命令及其子命令与参数
     for (size_t i = 0; i < argParse->commands_len; i++) {
-        __freeCommand(argParse->commands[i]);
+        __freeCommand(argParse, argParse->commands[i]);
     }
-    free(argParse->commands);
 
     // 释放全局参数
     for (size_t i = 0; i < argParse->global_args_len; i++) {
-        __freeCommandArgs(argParse->global_args[i]);
+        __freeCommandArgs(argParse, argParse->global_args[i]);
+    }
+
+    argParseHeapFree(argParse->commands);
+    argParseIndexFree(argParse, &argParse->commands_index);
+    argParseHeapFree(argParse->global_args);
+    argParseIndexFree(argParse, &argParse->global_args_index);
+    argParseHeapFree(argParse->documentation);
+}
+
+// 释放全部解析结果，命令树不受影响
+static void __freeResults(ArgParse *argParse) {
+    ArgParseState *state = argParse->state;
+    argParseReleaseResponseFiles(argParse);
+
+    ArgParseSlots *results = &state->results;
+    for (int i = 0; i < results->capacity; i++) {
+        ArgParseSlot *slot = &results->entries[i];
+        if (slot->node != NULL) {
+            __freeValues(argParse, slot->val, slot->val_len);
+        }
     }
-    if (argParse->val_len > 0) {
-        for (size_t i = 0; i < argParse->val_len; i++) {
-            free(argParse->val[i]);
+    argParseMemFree(argParse, results->entries);
+    __freeValues(argParse, state->val, state->val_len);
+    argParseMemFree(argParse, state->tokens);
+
+    state->results         = (ArgParseSlots){NULL, 0, 0};
+    state->tokens          = NULL;
+    state->tokens_cap      = 0;
+    state->val             = NULL;
+    state->val_len         = 0;
+    state->val_cap         = 0;
+    state->current_command = NULL;
+}
+
+void argParseFree(ArgParse *argParse) {
+    if (argParse->state != NULL && argParse->state->is_result) {
+        // 视图位于ArgParseResult开头，只释放该结果
+        argParseResultFree((ArgParseResult *)argParse);
+        return;
+    }
+    if (argParse->arena != NULL) {
+        // 内存池模式下整棵树与解析值都在池中，整体释放即可
+        argParseReleaseResponseFiles(argParse);
+        __helpCacheClear(argParse);
+        argParseArenaDestroy(argParse->arena);
+        return;
+    }
+
+    if (argParse->static_spec) {
+        // 静态规格只释放解析状态，之后可再次用于解析
+        if (argParse->state != NULL) {
+            __freeResults(argParse);
+            __helpCacheClear(argParse);
+            argParseHeapFree(argParse->state);
+            argParse->state = NULL;
         }
-        free(argParse->val);
+        return;
     }
 
-    free(argParse->global_args);
-    free(argParse->documentation);
-    free(argParse);
+    __freeResults(argParse);
+    __helpCacheClear(argParse);
+    __freeTree(argParse);
+    if (argParse->spec_file_size > 0) {
+        // 从规格文件加载的树就在映射中
+        ArgParseMapping mapping = {argParse->compiled,
+                                   argParse->spec_file_size};
+        argParseUnmapFile(&mapping);
+    } else {
+        argParseHeapFree(argParse->compiled);
+    }
+    argParseHeapFree(argParse);
 }
 /** End----------------内存释放API---------------- */
 
-/** Start----------------解析API---------------- */
+/** Start----------------重置API---------------- */
+
+// 清空一组解析值，保留数组本身供下次解析复用
+static void __resetValues(ArgParse *argParse, char **val, int *val_len) {
+    if (!argParse->borrow_values) {
+        for (int i = 0; i < *val_len; i++) {
+            argParseMemFree(argParse, val[i]);
+        }
+    }
+    *val_len = 0;
+}
+
+/**
+ * @brief 清除上一次解析的全部结果，使同一解析器可以再次解析
+ * 只遍历结果表，不访问命令树；各节点的槽位与值数组保留下来，下次解析时直接复用
+ * @param argParse 解析器指针
+ */
+void argParseReset(ArgParse *argParse) {
+    if (argParse == NULL || argParse->state == NULL) {
+        return;
+    }
+    ArgParseState *state = argParse->state;
+    for (int i = 0; i < state->results.capacity; i++) {
+        ArgParseSlot *slot = &state->results.entries[i];
+        __resetValues(argParse, slot->val, &slot->val_len);
+        slot->is_trigged = false;
+    }
+    __resetValues(argParse, state->val, &state->val_len);
+    argParseReleaseResponseFiles(argParse);
+    state->current_command = NULL;
+    state->argc            = 0;
+    state->argv            = NULL;
+    state->error           = _NoError;
+}
+
+/** End----------------重置API---------------- */
+
+/** Start----------------共享规格解析---------------- */
+
+const ArgParseSpec *argParseGetSpec(ArgParse *argParse) {
+    return (const ArgParseSpec *)argParse;
+}
+
+// 规格就是构造它的解析器，只是不再通过它修改命令树或解析
+static const ArgParse *__specParser(const ArgParseSpec *spec) {
+    return (const ArgParse *)spec;
+}
+
+// 视图共享规格的命令树与索引，解析状态从空开始，值总是分配在堆上
+static void __initView(ArgParse           *view,
+                       ArgParseState      *state,
+                       const ArgParseSpec *spec) {
+    *view       = *__specParser(spec);
+    view->arena = NULL;
+    view->state = state;
+    __initState(state, true);
+}
+
+ArgParseResult *
+argParseParseResult(const ArgParseSpec *spec, int argc, char *argv[]) {
+    if (spec == NULL) {
+        return NULL;
+    }
+    ArgParseResult *result = argParseMemAlloc(NULL, sizeof(ArgParseResult));
+    if (result == NULL) {
+        return NULL;
+    }
+
+    __initView(&result->view, &result->state, spec);
+    argParseParse(&result->view, argc, argv);
+    return result;
+}
+
+void argParseResultFree(ArgParseResult *result) {
+    if (result == NULL) {
+        return;
+    }
+    __freeResults(&result->view);
+    __helpCacheClear(&result->view);
+    argParseHeapFree(result);
+}
+
+// 结果的读取函数只读取视图的解析状态，与解析器的同名函数共用实现
+static ArgParse *__resultView(const ArgParseResult *result) {
+    return (ArgParse *)&result->view;
+}
+
+const ArgParseErrorInfo *argParseResultGetError(const ArgParseResult *result) {
+    return result != NULL ? argParseGetError(__resultView(result)) : NULL;
+}
+
+const Command *argParseResultGetCurCommand(const ArgParseResult *result) {
+    return result != NULL ? result->state.current_command : NULL;
+}
+
+char *argParseResultGetCurCommandName(const ArgParseResult *result) {
+    return result != NULL ? argParseGetCurCommandName(__resultView(result))
+                          : NULL;
+}
+
+char *argParseResultGetCurCommandValue(const ArgParseResult *result) {
+    return result != NULL ? argParseGetCurCommandValue(__resultView(result))
+                          : NULL;
+}
+
+char **argParseResultGetCurCommandValues(const ArgParseResult *result,
+                                         int                  *len) {
+    return result != NULL
+               ? argParseGetCurCommandValues(__resultView(result), len)
+               : NULL;
+}
+
+char *argParseResultGetCurArg(const ArgParseResult *result, const char *opt) {
+    return result != NULL ? argParseGetCurArg(__resultView(result), opt)
+                          : NULL;
+}
+
+char **argParseResultGetCurArgList(const ArgParseResult *result,
+                                   const char           *opt,
+                                   int                  *len) {
+    return result != NULL
+               ? argParseGetCurArgList(__resultView(result), opt, len)
+               : NULL;
+}
+
+char *argParseResultGetGlobalArg(const ArgParseResult *result,
+                                 const char           *opt) {
+    return result != NULL ? argParseGetGlobalArg(__resultView(result), opt)
+                          : NULL;
+}
+
+char **argParseResultGetGlobalArgList(const ArgParseResult *result,
+                                      const char           *opt,
+                                      int                  *len) {
+    return result != NULL
+               ? argParseGetGlobalArgList(__resultView(result), opt, len)
+               : NULL;
+}
+
+bool argParseResultCheckCurArgTriggered(const ArgParseResult *result,
+                                        const char           *opt) {
+    return result != NULL &&
+           argParseCheckCurArgTriggered(__resultView(result), opt);
+}
+
+bool argParseResultCheckCommandTriggered(const ArgParseResult *result,
+                                         const char           *command_name) {
+    return result != NULL &&
+           argParseCheckCommandTriggered(__resultView(result), command_name);
+}
+
+bool argParseResultCheckGlobalTriggered(const ArgParseResult *result,
+                                        const char           *opt) {
+    return result != NULL &&
+           argParseCheckGlobalTriggered(__resultView(result), opt);
+}
+
+char *argParseResultGetVal(const ArgParseResult *result) {
+    return result != NULL ? argParseGetVal(__resultView(result)) : NULL;
+}
+
+char **argParseResultGetValList(const ArgParseResult *result, int *len) {
+    return result != NULL ? argParseGetValList(__resultView(result), len)
+                          : NULL;
+}
+
+/** End----------------共享规格解析---------------- */
+
+/** Start----------------批量解析---------------- */
+
+#define BATCH_CHUNK 64 // 工作线程每次领取的命令行条数，摊薄领取时的原子操作
+
+typedef struct BatchJob {
+    const ArgParseSpec *spec;    // 共享的解析规格
+    const ArgParseArgv *lines;   // 命令行数组
+    ArgParseErrorInfo  *results; // 各条的解析结论
+    int                 count;   // 命令行条数
+    int                 next;    // 下一条未领取的命令行，原子递增
+    int                 failed;  // 解析失败的条数，原子累加
+} BatchJob;
+
+// 参数是否位于本次解析建立的@file映射中，映射在重置时解除
+static bool __inMappings(const ArgParseState *state, const char *token) {
+    for (int i = 0; i < state->mappings_len; i++) {
+        const char *addr = state->mappings[i].addr;
+        if (token >= addr && token < addr + state->mappings[i].size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 工作线程：反复领取一段命令行，用同一个视图逐条解析并重置
+ * 视图借用argv中的值，重置时只清空计数，稳定后解析不再分配内存
+ * @param ctx 批量解析任务
+ */
+static void __batchWorker(void *ctx) {
+    BatchJob     *job = ctx;
+    ArgParse      view;
+    ArgParseState state;
+    __initView(&view, &state, job->spec);
+    view.exit_on_error = false;
+    view.borrow_values = true;
+
+    int failed = 0;
+    while (true) {
+        int start = argParseAtomicAdd(&job->next, BATCH_CHUNK);
+        if (start >= job->count) {
+            break;
+        }
+        int end = job->count - start > BATCH_CHUNK ? start + BATCH_CHUNK
+                                                   : job->count;
+        for (int i = start; i < end; i++) {
+            const ArgParseArgv *line = &job->lines[i];
+            ArgParseErrorInfo  *out  = &job->results[i];
+            if (argParseParse(&view, line->argc, line->argv) == ArgParseOK) {
+                *out         = state.error;
+                out->command = state.current_command;
+            } else {
+                *out = state.error;
+                if (out->token != NULL && __inMappings(&state, out->token)) {
+                    out->token = NULL;
+                }
+                failed++;
+            }
+            argParseReset(&view);
+        }
+    }
+    argParseAtomicAdd(&job->failed, failed);
+
+    __freeResults(&view);
+    __helpCacheClear(&view);
+}
+
+int argParseParseBatch(const ArgParseSpec *spec,
+                       const ArgParseArgv *lines,
+                       int                 count,
+                       int                 threads,
+                       ArgParseErrorInfo  *results) {
+    if (spec == NULL || count < 0 ||
+        (count > 0 && (lines == NULL || results == NULL))) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    // 每个线程至少能领到一段，多余的线程只会空转
+    int chunks = (count - 1) / BATCH_CHUNK + 1;
+    if (threads <= 0) {
+        threads = argParseCpuCount();
+    }
+    if (threads > chunks) {
+        threads = chunks;
+    }
+
+    BatchJob job = {spec, lines, results, count, 0, 0};
+    argParseRunWorkers(threads, __batchWorker, &job);
+    return argParseAtomicLoad(&job.failed);
+}
+
+/** End----------------批量解析---------------- */
+
+/** Start----------------规格编译---------------- */
+
+typedef struct CompileLayout {
+    int    commands; // 命令节点数
+    int    args;     // 参数节点数
+    int    indexes;  // 非空的索引数
+    int    entries;  // 索引槽位数
+    size_t strings;  // 字符串字节数，含结尾'\0'
+} CompileLayout;     // 编译后连续块中各区域的大小
+
+typedef struct CompileCursor {
+    Command            *commands;     // 命令节点区
+    CommandArgs        *args;         // 参数节点区
+    Command           **command_ptrs; // 命令指针数组区
+    CommandArgs       **arg_ptrs;     // 参数指针数组区
+    ArgParseIndex      *indexes;      // 索引区
+    ArgParseIndexEntry *entries;      // 索引槽位区
+    char               *strings;      // 字符串表
+} CompileCursor;                      // 各区域的下一个空闲位置
+
+static size_t __strSize(const char *str) {
+    return str == NULL ? 0 : strlen(str) + 1;
+}
+
+// 与argParseIndexInsert的扩容规则一致，保证编译后的负载因子不超过1/2
+static int __indexCapacity(int len) {
+    if (len == 0) {
+        return 0;
+    }
+    int capacity = 8;
+    while (capacity < len * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// 索引中去重后的键数，没有索引时为0
+static int __indexLen(const ArgParseIndex *index) {
+    return index != NULL ? index->len : 0;
+}
+
+static void __layoutIndex(CompileLayout *layout, const ArgParseIndex *index) {
+    if (__indexLen(index) > 0) {
+        layout->indexes++;
+        layout->entries += __indexCapacity(index->len);
+    }
+}
+
+static void __layoutArgs(CompileLayout       *layout,
+                         CommandArgs        **args,
+                         int                  len,
+                         const ArgParseIndex *index) {
+    layout->args += len;
+    __layoutIndex(layout, index);
+    for (int i = 0; i < len; i++) {
+        layout->strings += __strSize(args[i]->short_opt) +
+                           __strSize(args[i]->long_opt) +
+                           __strSize(args[i]->default_val) +
+                           __strSize(args[i]->help);
+    }
+}
+
+static void __layoutCommands(CompileLayout       *layout,
+                             Command            **commands,
+                             int                  len,
+                             const ArgParseIndex *index) {
+    layout->commands += len;
+    __layoutIndex(layout, index);
+    for (int i = 0; i < len; i++) {
+        Command *command  = commands[i];
+        layout->strings  += __strSize(command->name) +
+                           __strSize(command->help) +
+                           __strSize(command->default_val);
+        __layoutArgs(
+            layout, command->args, command->args_len, command->args_index);
+        __layoutCommands(layout,
+                         command->sub_commands,
+                         command->sub_commands_len,
+                         command->sub_commands_index);
+    }
+}
+
+static char *__packStr(CompileCursor *cursor, const char *str) {
+    if (str == NULL) {
+        return NULL;
+    }
+    size_t size = strlen(str) + 1;
+    char  *mem  = cursor->strings;
+    memcpy(mem, str, size);
+    cursor->strings += size;
+    return mem;
+}
+
+// 在块中预留索引与恰好够用的槽位，之后的插入不会再扩容；没有键时为NULL
+static ArgParseIndex *__packIndex(CompileCursor *cursor, int len) {
+    if (len == 0) {
+        return NULL;
+    }
+    ArgParseIndex *index = cursor->indexes++;
+    *index = (ArgParseIndex){cursor->entries, __indexCapacity(len), 0, NULL};
+    memset(index->entries, 0, index->capacity * sizeof(ArgParseIndexEntry));
+    cursor->entries += index->capacity;
+    return index;
+}
+
+/**
+ * @brief 把一组参数复制到连续块中并重建索引
+ * @param argParse 解析器
+ * @param cursor 块游标
+ * @param args 原参数数组
+ * @param len 参数个数
+ * @param index 原索引，返回时替换为块中的新索引
+ * @return 块中的参数指针数组，无参数时为NULL
+ */
+static CommandArgs **__packArgs(ArgParse       *argParse,
+                                CompileCursor  *cursor,
+                                CommandArgs   **args,
+                                int             len,
+                                ArgParseIndex **index) {
+    CommandArgs **packed  = cursor->arg_ptrs;
+    cursor->arg_ptrs     += len;
+    *index                = __packIndex(cursor, __indexLen(*index));
+
+    for (int i = 0; i < len; i++) {
+        CommandArgs *arg  = cursor->args++;
+        *arg              = *args[i];
+        arg->short_opt    = __packStr(cursor, args[i]->short_opt);
+        arg->long_opt     = __packStr(cursor, args[i]->long_opt);
+        arg->default_val  = __packStr(cursor, args[i]->default_val);
+        arg->help         = __packStr(cursor, args[i]->help);
+        packed[i]         = arg;
+
+        if (arg->short_opt != NULL) {
+            argParseIndexInsert(argParse, index, arg->short_opt, arg);
+        }
+        if (arg->long_opt != NULL) {
+            argParseIndexInsert(argParse, index, arg->long_opt, arg);
+        }
+    }
+    return len > 0 ? packed : NULL;
+}
+
+/**
+ * @brief 把一组命令及其子树复制到连续块中，兄弟节点相邻存放
+ * @param argParse 解析器
+ * @param cursor 块游标
+ * @param commands 原命令数组
+ * @param len 命令个数
+ * @param index 原索引，返回时替换为块中的新索引
+ * @return 块中的命令指针数组，无命令时为NULL
+ */
+static Command **__packCommands(ArgParse       *argParse,
+                                CompileCursor  *cursor,
+                                Command       **commands,
+                                int             len,
+                                ArgParseIndex **index) {
+    Command **packed      = cursor->command_ptrs;
+    Command  *nodes       = cursor->commands;
+    cursor->command_ptrs += len;
+    cursor->commands     += len;
+    *index                = __packIndex(cursor, __indexLen(*index));
+
+    for (int i = 0; i < len; i++) {
+        Command *command     = &nodes[i];
+        *command             = *commands[i];
+        command->name        = __packStr(cursor, commands[i]->name);
+        command->help        = __packStr(cursor, commands[i]->help);
+        command->default_val = __packStr(cursor, commands[i]->default_val);
+        packed[i]            = command;
+        argParseIndexInsert(argParse, index, command->name, command);
+    }
+
+    // 子树放在全部兄弟节点之后，分派时同层节点位于相邻缓存行
+    for (int i = 0; i < len; i++) {
+        Command *command      = &nodes[i];
+        command->args         = __packArgs(argParse,
+                                   cursor,
+                                   command->args,
+                                   command->args_len,
+                                   &command->args_index);
+        command->sub_commands = __packCommands(argParse,
+                                               cursor,
+                                               command->sub_commands,
+                                               command->sub_commands_len,
+                                               &command->sub_commands_index);
+    }
+    return len > 0 ? packed : NULL;
+}
+
+typedef struct PackedTree {
+    char           *documentation;     // 帮助文档
+    CommandArgs   **global_args;       // 全局参数
+    ArgParseIndex  *global_args_index; // 全局参数索引
+    Command       **commands;          // 命令
+    ArgParseIndex  *commands_index;    // 命令索引
+} PackedTree;                          // 打包到块中的根节点属性
+
+// 统计整棵树打包后各区域的大小
+static CompileLayout __layoutTree(ArgParse *argParse) {
+    CompileLayout layout = {0, 0, 0, 0, __strSize(argParse->documentation)};
+    __layoutArgs(&layout,
+                 argParse->global_args,
+                 argParse->global_args_len,
+                 argParse->global_args_index);
+    __layoutCommands(&layout,
+                     argParse->commands,
+                     argParse->commands_len,
+                     argParse->commands_index);
+    return layout;
+}
+
+static size_t __layoutSize(const CompileLayout *layout) {
+    return layout->commands * (sizeof(Command) + sizeof(Command *)) +
+           layout->args * (sizeof(CommandArgs) + sizeof(CommandArgs *)) +
+           layout->indexes * sizeof(ArgParseIndex) +
+           layout->entries * sizeof(ArgParseIndexEntry) + layout->strings;
+}
+
+// 按布局划分块中各区域
+static CompileCursor __layoutCursor(const CompileLayout *layout, char *block) {
+    CompileCursor cursor;
+    cursor.commands     = (Command *)block;
+    cursor.args         = (CommandArgs *)(cursor.commands + layout->commands);
+    cursor.command_ptrs = (Command **)(cursor.args + layout->args);
+    cursor.arg_ptrs =
+        (CommandArgs **)(cursor.command_ptrs + layout->commands);
+    cursor.indexes = (ArgParseIndex *)(cursor.arg_ptrs + layout->args);
+    cursor.entries = (ArgParseIndexEntry *)(cursor.indexes + layout->indexes);
+    cursor.strings = (char *)(cursor.entries + layout->entries);
+    return cursor;
+}
+
+/**
+ * @brief 把整棵树复制到连续块中，原树不受影响
+ * 块内依次为命令节点、参数节点、指针数组、索引、索引槽位与字符串表
+ * @param argParse 解析器
+ * @param layout __layoutTree统计的布局
+ * @param block 至少__layoutSize字节的内存
+ * @return 块中的根节点属性
+ */
+static PackedTree
+__packTree(ArgParse *argParse, const CompileLayout *layout, char *block) {
+    CompileCursor cursor = __layoutCursor(layout, block);
+    PackedTree    tree;
+    tree.global_args_index = argParse->global_args_index;
+    tree.commands_index    = argParse->commands_index;
+    tree.documentation     = __packStr(&cursor, argParse->documentation);
+    tree.global_args       = __packArgs(argParse,
+                                  &cursor,
+                                  argParse->global_args,
+                                  argParse->global_args_len,
+                                  &tree.global_args_index);
+    tree.commands          = __packCommands(argParse,
+                                   &cursor,
+                                   argParse->commands,
+                                   argParse->commands_len,
+                                   &tree.commands_index);
+    return tree;
+}
+
+/**
+ * @brief 将构造完成的命令树冻结为一块连续内存
+ * 索引槽位中预存名字的哈希与长度，解析时查找只访问这块内存
+ * @param argParse 解析器
+ * @return 成功返回true，静态规格或内存分配失败返回false
+ */
+static bool __argParseCompile(ArgParse *argParse) {
+    if (argParse == NULL || argParse->static_spec) {
+        return false;
+    }
+    if (argParse->compiled != NULL) {
+        return true;
+    }
+    // 编译后不能再添加节点，延迟构造的命令先全部构造
+    __buildAll(argParse->commands, argParse->commands_len);
+
+    CompileLayout layout = __layoutTree(argParse);
+    char         *block  = argParseMemAlloc(argParse, __layoutSize(&layout));
+    if (block == NULL) {
+        return false;
+    }
+    PackedTree tree = __packTree(argParse, &layout, block);
+
+    // 之前的解析结果与帮助缓存以旧节点为键，一并丢弃；内存池模式下旧节点随池回收
+    __freeResults(argParse);
+    __helpCacheClear(argParse);
+    if (argParse->arena == NULL) {
+        __freeTree(argParse);
+    }
+
+    argParse->documentation     = tree.documentation;
+    argParse->global_args       = tree.global_args;
+    argParse->global_args_index = tree.global_args_index;
+    argParse->commands          = tree.commands;
+    argParse->commands_index    = tree.commands_index;
+    argParse->compiled          = block;
+    return true;
+}
+
+bool argParseCompile(ArgParse *argParse) {
+    SPEC_BEGIN(argParse);
+    bool compiled = __argParseCompile(argParse);
+    SPEC_END();
+    return compiled;
+}
+
+/** End----------------规格编译---------------- */
+
+/** Start----------------规格文件---------------- */
+
+#define SPEC_MAGIC      "CARGSPEC" // 规格文件标识，不含结尾'\0'
+#define SPEC_VERSION    3          // 格式版本，文件布局变化时递增
+#define SPEC_BYTE_ORDER 0x01020304 // 以写入平台的字节序保存，用于识别字节序
+
+enum {
+    SPEC_UNSAVABLE_CALLBACK    = -1, // 用户回调，不能保存
+    SPEC_NO_CALLBACK           = 0,  // 无回调
+    SPEC_HELP_CALLBACK         = 1,  // argParseHelpCallback
+    SPEC_COMMAND_HELP_CALLBACK = 2,  // argParseCommandHelpCallback
+}; // 参数回调的标记，按参数节点顺序保存在命令树块之后的标记表中
+
+typedef struct SpecHeader {
+    char           magic[8];          // SPEC_MAGIC
+    uint32_t       version;           // SPEC_VERSION
+    uint32_t       byte_order;        // SPEC_BYTE_ORDER
+    uint16_t       pointer_size;      // 指针宽度
+    uint16_t       command_size;      // Command大小
+    uint16_t       arg_size;          // CommandArgs大小
+    uint16_t       index_size;        // ArgParseIndex大小
+    uint16_t       entry_size;        // ArgParseIndexEntry大小
+    uint64_t       checksum;          // 本字段置0后整个文件的校验和
+    uint64_t       size;              // 文件总长度，总是8的倍数
+    int32_t        command_nodes;     // 命令节点数
+    int32_t        arg_nodes;         // 参数节点数
+    int32_t        index_nodes;       // 索引数
+    int32_t        entry_slots;       // 索引槽位数
+    int32_t        group_nodes;       // 命令组数
+    uint32_t       value_type;        // 程序值类型
+    uint64_t       strings;           // 命令树字符串表字节数
+    /* 根节点属性，指针保存为相对文件开头的偏移，0表示NULL */
+    char          *documentation;     // 帮助文档
+    Command      **commands;          // 命令
+    int32_t        commands_len;      // 命令个数
+    int32_t        global_args_len;   // 全局参数个数
+    ArgParseIndex *commands_index;    // 命令索引
+    CommandArgs  **global_args;       // 全局参数
+    ArgParseIndex *global_args_index; // 全局参数索引
+} SpecHeader; // 规格文件头，之后依次为命令树块、回调标记表、命令组节点与字符串
+
+typedef struct SpecReloc {
+    uintptr_t delta; // 加到每个非NULL指针上的值，保存时为映像起始地址的相反数
+    uintptr_t limit; // 加载时偏移须小于文件长度，保存时为0表示不检查
+    bool      ok;    // 全部偏移都在文件内
+} SpecReloc; // 映像中指针的改写方式
+
+static size_t __align8(size_t size) { return (size + 7) & ~(size_t)7; }
+
+// 命令树块紧跟在文件头之后，布局与argParseCompile生成的块相同
+static size_t __specTreeAt(void) { return __align8(sizeof(SpecHeader)); }
+
+// 每个参数节点一字节的回调标记
+static size_t __specTagsAt(const CompileLayout *layout) {
+    return __specTreeAt() + __layoutSize(layout);
+}
+
+static size_t __specGroupsAt(const CompileLayout *layout) {
+    return __align8(__specTagsAt(layout) + (size_t)layout->args);
+}
+
+static CompileLayout __specLayout(const SpecHeader *header) {
+    CompileLayout layout = {header->command_nodes,
+                            header->arg_nodes,
+                            header->index_nodes,
+                            header->entry_slots,
+                            (size_t)header->strings};
+    return layout;
+}
+
+// 按8字节一组做FNV-1a，每组一次乘法，比逐字节哈希快数倍
+static uint64_t __specChecksum(SpecHeader *header) {
+    uint64_t    checksum = header->checksum;
+    uint64_t    hash     = 14695981039346656037ull;
+    const char *data     = (const char *)header;
+    header->checksum     = 0;
+    for (size_t i = 0; i + 8 <= header->size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    header->checksum = checksum;
+    return hash;
+}
+
+static void *__reloc(SpecReloc *reloc, const void *ptr) {
+    if (ptr == NULL) {
+        return NULL;
+    }
+    if (reloc->limit != 0 && (uintptr_t)ptr >= reloc->limit) {
+        reloc->ok = false;
+        return NULL;
+    }
+    return (void *)((uintptr_t)ptr + reloc->delta);
+}
+
+// 规格文件只保存运行时构造的线性探测索引，不含完美哈希位移表
+static void __relocIndex(SpecReloc *reloc, ArgParseIndex *index) {
+    index->entries = __reloc(reloc, index->entries);
+    if (index->displace != NULL) {
+        reloc->ok = false;
+    }
+}
+
+/**
+ * @brief 按顺序改写映像中的全部指针，保存时把地址换成偏移，加载时换回地址
+ * 指针只出现在文件头、节点、指针数组、索引与索引槽位中，各区域依次线性遍历一遍
+ * @param header 映像开头的文件头
+ * @param reloc 改写方式
+ */
+static void __relocateSpec(SpecHeader *header, SpecReloc *reloc) {
+    CompileLayout layout = __specLayout(header);
+    CompileCursor cursor =
+        __layoutCursor(&layout, (char *)header + __specTreeAt());
+    CommandGroup *groups =
+        (CommandGroup *)((char *)header + __specGroupsAt(&layout));
+
+    header->documentation     = __reloc(reloc, header->documentation);
+    header->commands          = __reloc(reloc, header->commands);
+    header->commands_index    = __reloc(reloc, header->commands_index);
+    header->global_args       = __reloc(reloc, header->global_args);
+    header->global_args_index = __reloc(reloc, header->global_args_index);
+
+    for (int i = 0; i < layout.commands; i++) {
+        Command *command      = &cursor.commands[i];
+        command->name         = __reloc(reloc, command->name);
+        command->help         = __reloc(reloc, command->help);
+        command->group        = __reloc(reloc, command->group);
+        command->default_val  = __reloc(reloc, command->default_val);
+        command->args         = __reloc(reloc, command->args);
+        command->args_index   = __reloc(reloc, command->args_index);
+        command->sub_commands = __reloc(reloc, command->sub_commands);
+        command->sub_commands_index =
+            __reloc(reloc, command->sub_commands_index);
+    }
+    for (int i = 0; i < layout.args; i++) {
+        CommandArgs *arg = &cursor.args[i];
+        arg->short_opt   = __reloc(reloc, arg->short_opt);
+        arg->long_opt    = __reloc(reloc, arg->long_opt);
+        arg->default_val = __reloc(reloc, arg->default_val);
+        arg->help        = __reloc(reloc, arg->help);
+    }
+    for (int i = 0; i < layout.commands; i++) {
+        cursor.command_ptrs[i] = __reloc(reloc, cursor.command_ptrs[i]);
+    }
+    for (int i = 0; i < layout.args; i++) {
+        cursor.arg_ptrs[i] = __reloc(reloc, cursor.arg_ptrs[i]);
+    }
+    for (int i = 0; i < layout.indexes; i++) {
+        __relocIndex(reloc, &cursor.indexes[i]);
+    }
+    for (int i = 0; i < layout.entries; i++) {
+        cursor.entries[i].key   = __reloc(reloc, cursor.entries[i].key);
+        cursor.entries[i].value = __reloc(reloc, cursor.entries[i].value);
+    }
+    for (int i = 0; i < header->group_nodes; i++) {
+        groups[i].name = __reloc(reloc, groups[i].name);
+        groups[i].help = __reloc(reloc, groups[i].help);
+    }
+}
+
+static int __findGroup(CommandGroup **groups, int len, CommandGroup *group) {
+    for (int i = 0; i < len; i++) {
+        if (groups[i] == group) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 收集树中引用的命令组，同一命令组只收集一次
+static bool __collectGroups(Command        **commands,
+                            int              len,
+                            CommandGroup  ***groups,
+                            int             *groups_len) {
+    for (int i = 0; i < len; i++) {
+        CommandGroup *group = commands[i]->group;
+        if (group != NULL && __findGroup(*groups, *groups_len, group) < 0) {
+            CommandGroup **grown = argParseHeapRealloc(
+                *groups, (*groups_len + 1) * sizeof(CommandGroup *));
+            if (grown == NULL) {
+                return false;
+            }
+            *groups                = grown;
+            (*groups)[*groups_len] = group;
+            (*groups_len)++;
+        }
+        if (!__collectGroups(commands[i]->sub_commands,
+                             commands[i]->sub_commands_len,
+                             groups,
+                             groups_len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int __callbackTag(ArgParseCallback callback) {
+    if (callback == argParseHelpCallback) {
+        return SPEC_HELP_CALLBACK;
+    }
+    if (callback == argParseCommandHelpCallback) {
+        return SPEC_COMMAND_HELP_CALLBACK;
+    }
+    return callback == NULL ? SPEC_NO_CALLBACK : SPEC_UNSAVABLE_CALLBACK;
+}
+
+/**
+ * @brief 在内存中生成规格文件的映像，指针已换成偏移
+ * @param argParse 解析器
+ * @param size 返回映像长度
+ * @return 映像，由调用方释放，有不能保存的回调或内存不足时返回NULL
+ */
+static char *__specImage(ArgParse *argParse, size_t *size) {
+    CommandGroup **groups     = NULL;
+    int            groups_len = 0;
+    if (!__collectGroups(
+            argParse->commands, argParse->commands_len, &groups, &groups_len)) {
+        argParseHeapFree(groups);
+        return NULL;
+    }
+
+    CompileLayout layout    = __layoutTree(argParse);
+    size_t        groups_at = __specGroupsAt(&layout);
+    *size = groups_at + (size_t)groups_len * sizeof(CommandGroup);
+    for (int i = 0; i < groups_len; i++) {
+        *size += __strSize(groups[i]->name) + __strSize(groups[i]->help);
+    }
+    *size = __align8(*size);
+    char *image = argParseHeapAlloc(*size);
+    if (image == NULL) {
+        argParseHeapFree(groups);
+        return NULL;
+    }
+    // 对齐填充与未用的字段都置0，同一规格总是生成相同的文件
+    memset(image, 0, *size);
+
+    SpecHeader *header = (SpecHeader *)image;
+    PackedTree  tree   = __packTree(argParse, &layout, image + __specTreeAt());
+
+    CompileCursor cursor = __layoutCursor(&layout, image + __specTreeAt());
+    CommandGroup *nodes  = (CommandGroup *)(image + groups_at);
+    cursor.strings       = (char *)(nodes + groups_len);
+    for (int i = 0; i < groups_len; i++) {
+        nodes[i].name = __packStr(&cursor, groups[i]->name);
+        nodes[i].help = __packStr(&cursor, groups[i]->help);
+    }
+
+    // 所属解析器在加载时补上，帮助回调换成标记，其他回调无法保存
+    bool     savable = true;
+    uint8_t *tags    = (uint8_t *)image + __specTagsAt(&layout);
+    for (int i = 0; i < layout.commands; i++) {
+        Command *command = &cursor.commands[i];
+        int      group   = __findGroup(groups, groups_len, command->group);
+        if (command->callback != NULL) {
+            savable = false;
+        }
+        command->parser      = NULL;
+        command->group       = group < 0 ? NULL : &nodes[group];
+        command->callback    = NULL;
+        command->builder     = NULL;
+        command->builder_ctx = NULL;
+        command->build_state = COMMAND_BUILT;
+    }
+    for (int i = 0; i < layout.args; i++) {
+        CommandArgs *arg = &cursor.args[i];
+        int          tag = __callbackTag(arg->callback);
+        if (tag == SPEC_UNSAVABLE_CALLBACK || arg->value_callback != NULL) {
+            savable = false;
+        }
+        tags[i]             = (uint8_t)tag;
+        arg->callback       = NULL;
+        arg->value_callback = NULL;
+        arg->value_ctx      = NULL;
+    }
+    argParseHeapFree(groups);
+    if (!savable) {
+        argParseHeapFree(image);
+        return NULL;
+    }
+
+    memcpy(header->magic, SPEC_MAGIC, sizeof(header->magic));
+    header->version           = SPEC_VERSION;
+    header->byte_order        = SPEC_BYTE_ORDER;
+    header->pointer_size      = sizeof(void *);
+    header->command_size      = sizeof(Command);
+    header->arg_size          = sizeof(CommandArgs);
+    header->index_size        = sizeof(ArgParseIndex);
+    header->entry_size        = sizeof(ArgParseIndexEntry);
+    header->value_type        = argParse->value_type;
+    header->size              = *size;
+    header->command_nodes     = layout.commands;
+    header->arg_nodes         = layout.args;
+    header->index_nodes       = layout.indexes;
+    header->entry_slots       = layout.entries;
+    header->group_nodes       = groups_len;
+    header->strings           = layout.strings;
+    header->documentation     = tree.documentation;
+    header->commands          = tree.commands;
+    header->commands_len      = argParse->commands_len;
+    header->global_args_len   = argParse->global_args_len;
+    header->commands_index    = tree.commands_index;
+    header->global_args       = tree.global_args;
+    header->global_args_index = tree.global_args_index;
+
+    SpecReloc reloc = {(uintptr_t)0 - (uintptr_t)image, 0, true};
+    __relocateSpec(header, &reloc);
+    header->checksum = __specChecksum(header);
+    return image;
+}
+
+bool argParseSaveSpec(ArgParse *argParse, const char *path) {
+    if (argParse == NULL || path == NULL || argParse->static_spec ||
+        argParse->state->is_result) {
+        return false;
+    }
+    if (argParse->value_callback != NULL) {
+        return false; // 程序值的逐值回调同样不能保存
+    }
+    // 文件中只有完整的树，延迟构造的命令先全部构造
+    __buildAll(argParse->commands, argParse->commands_len);
+
+    size_t size  = 0;
+    char  *image = __specImage(argParse, &size);
+    if (image == NULL) {
+        return false;
+    }
+    FILE *file = fopen(path, "wb");
+    bool  ok   = file != NULL && fwrite(image, 1, size, file) == size;
+    if (file != NULL && fclose(file) != 0) {
+        ok = false;
+    }
+    argParseHeapFree(image);
+    return ok;
+}
+
+typedef struct SpecRegion {
+    size_t begin;  // 区域开头相对文件开头的偏移
+    size_t end;    // 区域结尾的偏移
+    size_t stride; // 元素大小
+} SpecRegion;      // 文件中一个定长元素区域的范围
+
+static SpecRegion __specRegion(const SpecHeader *header,
+                               const void       *start,
+                               int               count,
+                               size_t            stride) {
+    size_t begin = (size_t)((const char *)start - (const char *)header);
+    return (SpecRegion){begin, begin + (size_t)count * stride, stride};
+}
+
+/**
+ * @brief 检查保存为偏移的指针指向区域中某个元素的开头，且从它起count个元素
+ * 都在区域内；偏移为0(NULL)时count须为0
+ * @param ptr 保存为偏移的指针
+ * @param region 区域
+ * @param count 元素个数，负数视为越界
+ * @return 是否在区域内
+ */
+static bool
+__specInRegion(const void *ptr, const SpecRegion *region, int count) {
+    size_t offset = (size_t)(uintptr_t)ptr;
+    if (offset == 0) {
+        return count == 0;
+    }
+    return count >= 0 && offset >= region->begin && offset <= region->end &&
+           (offset - region->begin) % region->stride == 0 &&
+           (size_t)count <= (region->end - offset) / region->stride;
+}
+
+// 字符串偏移为0或指向文件内以'\0'结尾的字符串
+static bool __specString(const SpecHeader *header, const char *str) {
+    size_t offset = (size_t)(uintptr_t)str;
+    if (offset == 0) {
+        return true;
+    }
+    return offset < header->size &&
+           memchr((const char *)header + offset,
+                  '\0',
+                  header->size - offset) != NULL;
+}
+
+typedef struct SpecRegions {
+    SpecRegion commands;     // 命令节点
+    SpecRegion args;         // 参数节点
+    SpecRegion command_ptrs; // 命令指针数组
+    SpecRegion arg_ptrs;     // 参数指针数组
+    SpecRegion indexes;      // 索引
+    SpecRegion entries;      // 索引槽位
+    SpecRegion groups;       // 命令组节点
+} SpecRegions;               // 文件中各区域的范围，用于检查偏移
+
+/**
+ * @brief 检查索引指针与索引本身：槽位数为2的幂且留有空槽，槽位都在槽位区内，
+ * 键是文件内的字符串，值指向values区域中的节点
+ * @param header 文件头
+ * @param regions 各区域
+ * @param index 保存为偏移的索引指针，可为NULL
+ * @param values 值所在的节点区域
+ * @return 是否合法
+ */
+static bool __checkSpecIndex(const SpecHeader  *header,
+                             const SpecRegions *regions,
+                             ArgParseIndex     *index,
+                             const SpecRegion  *values) {
+    if (index == NULL) {
+        return true;
+    }
+    if (!__specInRegion(index, &regions->indexes, 1)) {
+        return false;
+    }
+    index = (ArgParseIndex *)((char *)header + (uintptr_t)index);
+    if (index->displace != NULL) {
+        return false;
+    }
+    if (index->entries == NULL) {
+        return index->capacity == 0 && index->len == 0;
+    }
+    // 线性探测需要至少一个空槽才能在找不到时停下
+    if (index->capacity <= 0 ||
+        (index->capacity & (index->capacity - 1)) != 0 || index->len < 0 ||
+        index->len >= index->capacity ||
+        !__specInRegion(index->entries, &regions->entries, index->capacity)) {
+        return false;
+    }
+    ArgParseIndexEntry *entries =
+        (ArgParseIndexEntry *)((char *)header + (uintptr_t)index->entries);
+    for (int i = 0; i < index->capacity; i++) {
+        ArgParseIndexEntry *entry  = &entries[i];
+        size_t              offset = (size_t)(uintptr_t)entry->key;
+        if (entry->key == NULL) {
+            continue;
+        }
+        if (!__specString(header, entry->key) ||
+            entry->key_len > header->size - offset ||
+            !__specInRegion(entry->value, values, 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 检查命令树中的每个偏移：数组与长度都在对应的区域内，索引与槽位合法，
+ * 字符串以'\0'结尾，回调等无法保存的字段为空；通过后改写指针与解析都不越界
+ * @param header 文件头，指针仍为偏移
+ * @return 是否合法
+ */
+static bool __checkSpecTree(const SpecHeader *header) {
+    CompileLayout layout = __specLayout(header);
+    CompileCursor cursor =
+        __layoutCursor(&layout, (char *)header + __specTreeAt());
+    CommandGroup *groups =
+        (CommandGroup *)((char *)header + __specGroupsAt(&layout));
+    SpecRegions regions = {
+        __specRegion(header, cursor.commands, layout.commands, sizeof(Command)),
+        __specRegion(header, cursor.args, layout.args, sizeof(CommandArgs)),
+        __specRegion(
+            header, cursor.command_ptrs, layout.commands, sizeof(Command *)),
+        __specRegion(
+            header, cursor.arg_ptrs, layout.args, sizeof(CommandArgs *)),
+        __specRegion(
+            header, cursor.indexes, layout.indexes, sizeof(ArgParseIndex)),
+        __specRegion(header,
+                     cursor.entries,
+                     layout.entries,
+                     sizeof(ArgParseIndexEntry)),
+        __specRegion(
+            header, groups, header->group_nodes, sizeof(CommandGroup)),
+    };
+
+    if (!__specString(header, header->documentation) ||
+        !__specInRegion(
+            header->commands, &regions.command_ptrs, header->commands_len) ||
+        !__specInRegion(
+            header->global_args, &regions.arg_ptrs, header->global_args_len) ||
+        !__checkSpecIndex(
+            header, &regions, header->commands_index, &regions.commands) ||
+        !__checkSpecIndex(
+            header, &regions, header->global_args_index, &regions.args)) {
+        return false;
+    }
+    for (int i = 0; i < layout.commands; i++) {
+        const Command *command = &cursor.commands[i];
+        if (!__specString(header, command->name) ||
+            !__specString(header, command->help) ||
+            !__specString(header, command->default_val) ||
+            (command->group != NULL &&
+             !__specInRegion(command->group, &regions.groups, 1)) ||
+            !__specInRegion(
+                command->args, &regions.arg_ptrs, command->args_len) ||
+            !__specInRegion(command->sub_commands,
+                            &regions.command_ptrs,
+                            command->sub_commands_len) ||
+            !__checkSpecIndex(
+                header, &regions, command->args_index, &regions.args) ||
+            !__checkSpecIndex(header,
+                              &regions,
+                              command->sub_commands_index,
+                              &regions.commands) ||
+            command->parser != NULL || command->callback != NULL ||
+            command->builder != NULL || command->builder_ctx != NULL ||
+            command->build_state != COMMAND_BUILT) {
+            return false;
+        }
+    }
+    for (int i = 0; i < layout.args; i++) {
+        const CommandArgs *arg = &cursor.args[i];
+        if (!__specString(header, arg->short_opt) ||
+            !__specString(header, arg->long_opt) ||
+            !__specString(header, arg->default_val) ||
+            !__specString(header, arg->help) || arg->callback != NULL ||
+            arg->value_callback != NULL || arg->value_ctx != NULL) {
+            return false;
+        }
+    }
+    for (int i = 0; i < layout.commands; i++) {
+        if (!__specInRegion(cursor.command_ptrs[i], &regions.commands, 1)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < layout.args; i++) {
+        if (!__specInRegion(cursor.arg_ptrs[i], &regions.args, 1)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < header->group_nodes; i++) {
+        if (!__specString(header, groups[i].name) ||
+            !__specString(header, groups[i].help) ||
+            groups[i].commands != NULL || groups[i].commands_len != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 检查文件头、校验和与命令树的结构，通过后才改写指针
+ * 校验和只能发现意外损坏，截断后重新计算过校验和或手工修改的文件
+ * 还需逐个检查偏移与长度，否则改写指针与解析时可能越界
+ * @param header 映射的文件开头
+ * @param size 文件长度
+ * @return 是否可以加载
+ */
+static bool __checkSpec(SpecHeader *header, size_t size) {
+    if (size < sizeof(SpecHeader) || size % 8 != 0 ||
+        memcmp(header->magic, SPEC_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != SPEC_VERSION ||
+        header->byte_order != SPEC_BYTE_ORDER ||
+        header->pointer_size != sizeof(void *) ||
+        header->command_size != sizeof(Command) ||
+        header->arg_size != sizeof(CommandArgs) ||
+        header->index_size != sizeof(ArgParseIndex) ||
+        header->entry_size != sizeof(ArgParseIndexEntry) ||
+        header->size != size || header->checksum != __specChecksum(header)) {
+        return false;
+    }
+    if (header->command_nodes < 0 || header->arg_nodes < 0 ||
+        header->index_nodes < 0 || header->entry_slots < 0 ||
+        header->group_nodes < 0 || header->strings > size) {
+        return false;
+    }
+    CompileLayout layout = __specLayout(header);
+    if (__specGroupsAt(&layout) +
+            (size_t)header->group_nodes * sizeof(CommandGroup) >
+        size) {
+        return false;
+    }
+    return __checkSpecTree(header);
+}
+
+// 补上加载后才能确定的所属解析器与帮助回调
+static bool __bindSpec(SpecHeader *header, ArgParse *argParse) {
+    CompileLayout  layout = __specLayout(header);
+    CompileCursor  cursor =
+        __layoutCursor(&layout, (char *)header + __specTreeAt());
+    const uint8_t *tags = (const uint8_t *)header + __specTagsAt(&layout);
+    for (int i = 0; i < layout.commands; i++) {
+        cursor.commands[i].parser = argParse;
+    }
+    for (int i = 0; i < layout.args; i++) {
+        CommandArgs *arg = &cursor.args[i];
+        switch (tags[i]) {
+        case SPEC_NO_CALLBACK:
+            arg->callback = NULL;
+            break;
+        case SPEC_HELP_CALLBACK:
+            arg->callback = argParseHelpCallback;
+            break;
+        case SPEC_COMMAND_HELP_CALLBACK:
+            arg->callback = argParseCommandHelpCallback;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+ArgParse *argParseLoadSpec(const char *path) {
+    ArgParseMapping mapping;
+    if (path == NULL || !argParseMapFile(path, &mapping)) {
+        return NULL;
+    }
+    SpecHeader *header = mapping.addr;
+    if (!__checkSpec(header, mapping.size)) {
+        argParseUnmapFile(&mapping);
+        return NULL;
+    }
+
+    ArgParse *argParse = __argParseAlloc(NULL, header->value_type);
+    if (argParse == NULL) {
+        argParseUnmapFile(&mapping);
+        return NULL;
+    }
+    // 映射是私有的，原地把偏移换成地址即可解析，文件本身不变
+    SpecReloc reloc = {(uintptr_t)mapping.addr, mapping.size, true};
+    __relocateSpec(header, &reloc);
+    if (!reloc.ok || !__bindSpec(header, argParse)) {
+        argParseHeapFree(argParse);
+        argParseUnmapFile(&mapping);
+        return NULL;
+    }
+
+    argParse->documentation     = header->documentation;
+    argParse->commands          = header->commands;
+    argParse->commands_len      = header->commands_len;
+    argParse->commands_index    = header->commands_index;
+    argParse->global_args       = header->global_args;
+    argParse->global_args_len   = header->global_args_len;
+    argParse->global_args_index = header->global_args_index;
+    argParse->compiled          = mapping.addr;
+    argParse->spec_file_size    = mapping.size;
+    return argParse;
+}
+
+/** End----------------规格文件---------------- */
+
+/** Start----------------解析API---------------- */
+
+// 记录错误，只写入固定大小的字段，不分配内存
+static void __recordError(ArgParse         *argParse,
+                          ArgParseErrorKind kind,
+                          int               index,
+                          const char       *token,
+                          const Command    *command) {
+    argParse->state->error = (ArgParseErrorInfo){kind, index, token, command};
+}
+
+// 按记录的错误生成提示信息，打印帮助后结束程序
+static NORETURN void __reportError(ArgParse *argParse) {
+    ArgParseErrorInfo *error   = &argParse->state->error;
+    Command           *command = (Command *)error->command;
+    char              *prefix  = NULL;
+    StrBuilder         msg;
+    strBuilderInit(&msg);
+
+    switch (error->kind) {
+    case ArgParseUNKNOWNCOMMAND:
+        strBuilderAppend(&msg,
+                         3,
+                         "\033[1;31mERROR\033[0m:",
+                         error->token,
+                         " is not a valid command");
+        break;
+    case ArgParseUNKNOWNOPTION:
+        prefix = argParseGenerateArgErrorMsg(
+            argParse, error->token, error->token[1] != '-');
+        break;
+    case ArgParseMISSINGREQUIRED:
+        if (command == NULL) {
+            strBuilderAppend(&msg,
+                             3,
+                             RED "ERROR" RESET ": Global Option " BLUE,
+                             error->token,
+                             RESET " is required");
+        } else {
+            strBuilderAppend(&msg,
+                             5,
+                             RED "ERROR" RESET ": Command " BLUE,
+                             command->name,
+                             RESET " Option " BLUE,
+                             error->token,
+                             RESET " is required");
+        }
+        break;
+    case ArgParseRESPONSEFILE:
+        strBuilderAppend(&msg,
+                         3,
+                         RED "ERROR" RESET ": Cannot read " BLUE,
+                         error->token,
+                         RESET);
+        break;
+    case ArgParseNOMEMORY:
+        // 不是参数的问题，不打印帮助，也不再为提示信息分配内存
+        fputs("ERROR: Out of memory\n", stderr);
+        argParseFree(argParse);
+        exit(1);
+    default:
+        break;
+    }
+    if (prefix == NULL) {
+        prefix = strBuilderDetach(&msg);
+    }
+    argParseError(argParse, command, prefix, NULL);
+}
+
+/**
+ * @brief 解析出错，记录错误后按exit_on_error决定是否结束程序
+ * @param argParse 解析器
+ * @param kind 错误类型
+ * @param index 出错参数的位置，无对应参数时为-1
+ * @param token 出错的参数或缺少的选项名
+ * @param command 出错时所在的命令，决定打印哪一级的帮助
+ * @return 不结束程序时返回-1，供各处理函数直接返回
+ */
+static int __fail(ArgParse         *argParse,
+                  ArgParseErrorKind kind,
+                  int               index,
+                  const char       *token,
+                  const Command    *command) {
+    __recordError(argParse, kind, index, token, command);
+    if (argParse->exit_on_error) {
+        __reportError(argParse);
+    }
+    return -1;
+}
+
+// 逐个把值交给回调，不保存也不复制
+static void __streamValues(ArgParse             *argParse,
+                           ArgParseValueCallback callback,
+                           void                 *ctx,
+                           char                **vals,
+                           int                   count) {
+    for (int i = 0; i < count; i++) {
+        callback(argParse, vals[i], ctx);
+    }
+}
+
+// 在命令参数中查找选项，command为NULL时查找全局参数
+static CommandArgs *__lookupOption(ArgParse      *argParse,
+                                   Command       *command,
+                                   const char    *name,
+                                   ArgParseToken *token) {
+    if (command != NULL) {
+        return argParseFindCommandArgs(command, name, token);
+    }
+    return argParseFindGlobalArgs(argParse, name, token);
+}
+
+/**
+ * @brief 查找选项，支持--name=value与-nvalue两种附带值的写法
+ * 名字按长度比较，附带的值指向argv中原有的字符串，不产生临时副本
+ * 短选项先按整个参数查找，找不到时再按前两个字符查找需要值的选项
+ * @param argParse 解析器
+ * @param command 在该命令的参数中查找，为NULL时查找全局参数
+ * @param index 参数位置
+ * @param attached 返回附带的值，没有时为NULL
+ * @return 找不到返回NULL
+ */
+static CommandArgs *__findOption(ArgParse *argParse,
+                                 Command  *command,
+                                 int       index,
+                                 char    **attached) {
+    ArgParseState *state = argParse->state;
+    char          *name  = state->argv[index];
+    ArgParseToken *token = &state->tokens[index];
+    CommandArgs   *arg   = __lookupOption(argParse, command, name, token);
+
+    *attached = NULL;
+    if (token->eq >= 0) {
+        if (arg != NULL) {
+            *attached = name + token->eq + 1;
+        }
+        return arg;
+    }
+    if (arg != NULL || token->type != SHORT_ARG || token->len <= 2) {
+        return arg;
+    }
+
+    ArgParseToken prefix = {2, -1, 0, SHORT_ARG, false};
+    arg                  = __lookupOption(argParse, command, name, &prefix);
+    if (arg == NULL || arg->value_type == ArgParseNOVALUE) {
+        return NULL;
+    }
+    *attached = name + 2;
+    return arg;
+}
 
 /**
- * @brief 解析命令行参数
+ * @brief 解析选项的值
  * @param argParse ArgParse结构体指针
- * @param command 命令结构体指针
  * @param arg 参数结构体指针
  * @param arg_index 参数索引
+ * @param attached 以--name=value或-nvalue附带的值，没有时为NULL
  * @return int 返回解析到的参数索引
  */
-int __processArgs(ArgParse *argParse, CommandArgs *arg, int arg_index) {
-    arg->is_trigged   = true; // 标记参数被触发
+int __processArgs(ArgParse    *argParse,
+                  CommandArgs *arg,
+                  int          arg_index,
+                  char        *attached) {
+    ArgParseState *state = argParse->state;
+    if (attached != NULL && arg->value_type == ArgParseNOVALUE) {
+        return __fail(argParse,
+                      ArgParseBADARGUMENT,
+                      arg_index,
+                      state->argv[arg_index],
+                      state->current_command);
+    }
+    // 标记参数被触发，记录失败或写入值失败时停止解析，不留下不完整的结果
+    if (!argParseMarkTriggered(argParse, arg)) {
+        return __fail(argParse, ArgParseNOMEMORY, arg_index, NULL, NULL);
+    }
+    STATS_ADD(options, 1);
 
     int current_index = arg_index;
 
+    // 附带的值是第一个值，多值选项之后仍可跟随其余的值
+    if (attached != NULL) {
+        if (arg->value_callback != NULL) {
+            __streamValues(
+                argParse, arg->value_callback, arg->value_ctx, &attached, 1);
+        } else if (!argParseSetArgVal(argParse, arg, attached)) {
+            return __fail(argParse, ArgParseNOMEMORY, arg_index, NULL, NULL);
+        }
+    }
+
     if (arg->value_type == ArgParseMULTIVALUE) {
-        for (int i = arg_index + 1; i < argParse->argc; i++) {
-            if (checkArgType(argParse->argv[i]) ==
-                COMMAND) { // COMMAND是无--或-开头的字符串，也可认定为参数值
-                argParseSetArgVal(arg, argParse->argv[i]);
-                current_index = i;
-            } else {
-                current_index = i - 1;
-                break;
-            }
+        // COMMAND是无--或-开头的字符串，也可认定为参数值
+        // 先找到整段值的结尾，值数组只需按段长分配一次
+        int count = argParseCountValues(
+            state->tokens, state->argc, arg_index + 1);
+        if (arg->value_callback != NULL) {
+            __streamValues(argParse,
+                           arg->value_callback,
+                           arg->value_ctx,
+                           state->argv + arg_index + 1,
+                           count);
+        } else if (!argParseSetArgVals(
+                       argParse, arg, state->argv + arg_index + 1, count)) {
+            return __fail(argParse, ArgParseNOMEMORY, arg_index, NULL, NULL);
         }
-    } else if (arg->value_type == ArgParseSINGLEVALUE) {
-        if (arg_index + 1 < argParse->argc) {
-            argParseSetArgVal(arg, argParse->argv[arg_index + 1]);
+        current_index = arg_index + count;
+    } else if (arg->value_type == ArgParseSINGLEVALUE && attached == NULL) {
+        if (arg_index + 1 < state->argc) {
+            if (arg->value_callback != NULL) {
+                __streamValues(argParse,
+                               arg->value_callback,
+                               arg->value_ctx,
+                               state->argv + arg_index + 1,
+                               1);
+            } else if (!argParseSetArgVal(
+                           argParse, arg, state->argv[arg_index + 1])) {
+                return __fail(
+                    argParse, ArgParseNOMEMORY, arg_index + 1, NULL, NULL);
+            }
             current_index = arg_index + 1;
         }
-    } else if (arg->value_type == ArgParseNOVALUE) {
-        current_index = arg_index;
     }
 
     if (arg->callback != NULL) {
-        arg->callback(argParse, arg->val, arg->val_len);
+        ArgParseSlot *slot = argParseSlotFind(&state->results, arg);
+        arg->callback(argParse,
+                      slot != NULL ? slot->val : NULL,
+                      slot != NULL ? slot->val_len : 0);
+
+        // 回调中记录的错误(例如帮助)定位到触发它的选项
+        if (state->error.kind != ArgParseOK) {
+            if (state->error.index < 0) {
+                state->error.index = arg_index;
+                state->error.token = state->argv[arg_index];
+            }
+            return -1;
+        }
     }
 
     return current_index;
@@ -355,107 +2250,122 @@ int __processSubCommand(ArgParse *argParse,
                         Command  *ParentCommand,
                         char     *name,
                         int       command_index) {
-
-    Command *sub_command = argParseFindSubCommand(ParentCommand, name);
+    ArgParseState *state       = argParse->state;
+    Command       *sub_command = argParseFindSubCommand(
+        ParentCommand, name, &state->tokens[command_index]);
     if (sub_command == NULL) {
-        argParseError(argParse, argParse->current_command, NULL, NULL);
-        return -1;
+        return __fail(argParse,
+                      ArgParseUNKNOWNCOMMAND,
+                      command_index,
+                      name,
+                      state->current_command);
     }
+    __buildCommand(sub_command);
     CommandArgs *arg          = NULL;
+    char        *attached     = NULL;
 
-    argParse->current_command = sub_command;
+    state->current_command = sub_command;
 
-    for (int i = command_index + 1; i < argParse->argc; i++) {
-        ArgType argType = checkArgType(argParse->argv[i]);
+    for (int i = command_index + 1; i < state->argc; i++) {
+        ArgType argType = state->tokens[i].type;
         switch (argType) {
         case COMMAND:
             return __processSubCommand(
-                argParse, sub_command, argParse->argv[i], i); // 递归处理子命令
+                argParse, sub_command, state->argv[i], i); // 递归处理子命令
         case LONG_ARG:
-            arg =
-                argParseFindCommandArgs(sub_command, argParse->argv[i], false);
+            arg = __findOption(argParse, sub_command, i, &attached);
             if (arg != NULL) {
-                i = __processArgs(argParse, arg, i);
+                i = __processArgs(argParse, arg, i, attached);
             }
             return i;
         case SHORT_ARG:
-            arg = argParseFindCommandArgs(sub_command, argParse->argv[i], true);
+            arg = __findOption(argParse, sub_command, i, &attached);
             if (arg != NULL) {
                 i = __processArgs(argParse,
                                   arg,
-                                  i); // 解析参数值并返回以解析到的索引位置
+                                  i,
+                                  attached); // 解析参数值并返回以解析到的索引位置
                 return i;
             } else {
-                argParseError(argParse, argParse->current_command, NULL, NULL);
-                return -1;
+                return __fail(argParse,
+                              ArgParseUNKNOWNOPTION,
+                              i,
+                              state->argv[i],
+                              sub_command);
             }
         default:
-            argParseError(argParse, argParse->current_command, NULL, NULL);
-            return -1;
+            return __fail(argParse,
+                          ArgParseBADARGUMENT,
+                          i,
+                          state->argv[i],
+                          sub_command);
         }
     }
-    argParseError(argParse, argParse->current_command, NULL, NULL);
-    return -1;
+    return __fail(
+        argParse, ArgParseINCOMPLETE, command_index, name, sub_command);
 }
 
 int __processVal(ArgParse *argParse, int index) {
-    CommandArgs *arg = NULL;
+    ArgParseState *state    = argParse->state;
+    CommandArgs   *arg      = NULL;
+    char          *attached = NULL;
 
-    for (int i = index; i < argParse->argc; i++) {
-        ArgType argType = checkArgType(argParse->argv[i]);
+    for (int i = index; i < state->argc; i++) {
+        ArgType argType = state->tokens[i].type;
         switch (argType) {
-        case COMMAND:
-            argParseSetVal(argParse, argParse->argv[i]);
-            break;
-        case LONG_ARG:
-            // 处理全局命令长选项
-            arg = argParseFindGlobalArgs(argParse, argParse->argv[i], false);
-            if (arg == NULL) {
-                char *msg = argParseGenerateArgErrorMsg(
-                    argParse, argParse->argv[i], false);
-                argParseError(argParse, argParse->current_command, msg, NULL);
-                return -1;
+        case COMMAND: {
+            int count = argParseCountValues(state->tokens, state->argc, i);
+            if (argParse->value_callback != NULL) {
+                __streamValues(argParse,
+                               argParse->value_callback,
+                               argParse->value_ctx,
+                               state->argv + i,
+                               count);
+            } else if (!argParseSetVals(argParse, state->argv + i, count)) {
+                return __fail(argParse, ArgParseNOMEMORY, i, NULL, NULL);
             }
-            i = __processArgs(argParse, arg, i);
+            i += count - 1;
             break;
+        }
+        case LONG_ARG:
         case SHORT_ARG:
-            // 处理全局命令短选项
-            arg = argParseFindGlobalArgs(argParse, argParse->argv[i], true);
+            // 处理全局命令长短选项
+            arg = __findOption(argParse, NULL, i, &attached);
             if (arg == NULL) {
-                char *msg = argParseGenerateArgErrorMsg(
-                    argParse, argParse->argv[i], true);
-                argParseError(argParse, argParse->current_command, msg, NULL);
-                return -1; // 错误处理
+                return __fail(argParse,
+                              ArgParseUNKNOWNOPTION,
+                              i,
+                              state->argv[i],
+                              state->current_command);
             }
             i = __processArgs(
-                argParse, arg, i); // 解析参数值并返回以解析到的索引位置
+                argParse, arg, i, attached); // 解析参数值并返回以解析到的索引位置
+            if (i < 0) {
+                return -1;
+            }
             break;
         default:
-            argParseError(
-                argParse, argParse->current_command, "unknown error", NULL);
-            return -1;
+            return __fail(argParse,
+                          ArgParseBADARGUMENT,
+                          i,
+                          state->argv[i],
+                          state->current_command);
         }
     }
-    return argParse->argc - 1;
+    return state->argc - 1;
 }
 
 // 处理命令参数
 int __processCommand(ArgParse *argParse, char *name, int command_index) {
-    CommandArgs *arg     = NULL;
-    Command     *command = NULL;
-
-    command              = argParseFindCommand(argParse, name); // 查找命令
+    ArgParseState *state    = argParse->state;
+    CommandArgs   *arg      = NULL;
+    char          *attached = NULL;
+    Command       *command  = argParseFindCommand(
+        argParse, name, &state->tokens[command_index]); // 查找命令
 
     if (command == NULL && argParse->value_type == ArgParseNOVALUE) {
-        char *msg = NULL;
-        if (name != NULL) {
-            msg = stringNewCopy("\033[1;31mERROR\033[0m:");
-            __catStr(&msg, 1, name);
-            __catStr(&msg, 1, " is not a valid command");
-        }
-
-        argParseError(argParse, command, msg, NULL);
-        return -1;
+        return __fail(
+            argParse, ArgParseUNKNOWNCOMMAND, command_index, name, NULL);
     }
 
     if (command == NULL && argParse->value_type != ArgParseNOVALUE) {
@@ -463,168 +2373,271 @@ int __processCommand(ArgParse *argParse, char *name, int command_index) {
     }
 
     if (command != NULL) {
-        command->is_trigged       = true; // 标记命令被触发
-        argParse->current_command = command;
+        __buildCommand(command); // 延迟构造的命令在第一次分派时构造
+        if (!argParseMarkTriggered(argParse, command)) { // 标记命令被触发
+            return __fail(
+                argParse, ArgParseNOMEMORY, command_index, NULL, NULL);
+        }
+        state->current_command = command;
     }
 
-    for (int i = command_index + 1; i < argParse->argc; i++) {
-        ArgType argType = checkArgType(argParse->argv[i]);
+    for (int i = command_index + 1; i < state->argc; i++) {
+        ArgType argType = state->tokens[i].type;
         switch (argType) {
         case COMMAND: {
             // 命令无值则处理子命令
             if (command->value_type == ArgParseNOVALUE) {
-                __processSubCommand(argParse, command, argParse->argv[i], i);
-                return argParse->argc - 1;
+                if (__processSubCommand(
+                        argParse, command, state->argv[i], i) < 0) {
+                    return -1;
+                }
+                return state->argc - 1;
             } else {
-                // 命令有值，则认为该值是命令值
-                argParseSetCommandVal(command, argParse->argv[i]);
+                // 命令有值，则认为该值是命令值，整段一次写入
+                int count = argParseCountValues(state->tokens, state->argc, i);
+                if (!argParseSetCommandVals(
+                        argParse, command, state->argv + i, count)) {
+                    return __fail(argParse, ArgParseNOMEMORY, i, NULL, NULL);
+                }
+                i += count - 1;
             }
             break;
         }
         case LONG_ARG:
-            // 处理命令长选项
-            arg = argParseFindCommandArgs(command, argParse->argv[i], false);
+        case SHORT_ARG:
+            // 处理命令长短选项
+            arg = __findOption(argParse, command, i, &attached);
             if (arg == NULL) {
                 // 可能全局参数被放在了命令参数之前
-                arg =
-                    argParseFindGlobalArgs(argParse, argParse->argv[i], false);
-                if (arg == NULL) {
-                    char *msg = argParseGenerateArgErrorMsg(
-                        argParse, argParse->argv[i], false);
-                    argParseError(
-                        argParse, argParse->current_command, msg, NULL);
-                    return -1;
-                }
-                i = __processArgs(argParse, arg, i);
-                break;
+                arg = __findOption(argParse, NULL, i, &attached);
             }
-            i = __processArgs(argParse, arg, i);
-            break;
-        case SHORT_ARG:
-            // 处理命令短选项
-            arg = argParseFindCommandArgs(command, argParse->argv[i], true);
             if (arg == NULL) {
-                // 可能全局参数被放在了命令参数之前
-                arg = argParseFindGlobalArgs(argParse, argParse->argv[i], true);
-                if (arg == NULL) {
-                    char *msg = argParseGenerateArgErrorMsg(
-                        argParse, argParse->argv[i], true);
-                    argParseError(
-                        argParse, argParse->current_command, msg, NULL);
-                    return -1;
-                }
-                i = __processArgs(
-                    argParse, arg, i); // 解析参数值并返回以解析到的索引位置
-                break;
+                return __fail(argParse,
+                              ArgParseUNKNOWNOPTION,
+                              i,
+                              state->argv[i],
+                              state->current_command);
+            }
+            i = __processArgs(
+                argParse, arg, i, attached); // 解析参数值并返回以解析到的索引位置
+            if (i < 0) {
+                return -1;
             }
-            i = __processArgs(argParse,
-                              arg,
-                              i); // 解析参数值并返回以解析到的索引位置
             break;
         default:
-            argParseError(argParse, argParse->current_command, NULL, NULL);
-            return -1;
+            return __fail(argParse,
+                          ArgParseBADARGUMENT,
+                          i,
+                          state->argv[i],
+                          state->current_command);
         }
     }
 
-    return argParse->argc - 1;
+    return state->argc - 1;
 }
 
-/**
- * @brief 解析命令行参数
- * @errors: 错误信息字符串统一又调用方申请，处理函数释放
- * @param argParse 解析器指针
- * @param argc 参数个数
- * @param argv 参数列表
- */
-void argParseParse(ArgParse *argParse, int argc, char *argv[]) {
-    argParse->argc   = argc;
-    argParse->argv   = argv;
+// 解析命令行参数，统计开启时各阶段的耗时累加到argParse->stats
+static ArgParseErrorKind
+__argParseParse(ArgParse *argParse, int argc, char *argv[]) {
+    ArgParseState *state = argParse->state;
+    state->argc  = argc;
+    state->argv  = argv;
+    state->error = _NoError;
+    STATS_CLOCK(phase);
+
+    if (argParse->response_files) {
+        // 展开后的参数与命令行参数走完全相同的解析路径
+        const char *failed       = NULL;
+        int         failed_index = -1;
+        if (!argParseExpandResponseFiles(
+                argParse, argc, argv, &failed, &failed_index)) {
+            __fail(argParse,
+                   ArgParseRESPONSEFILE,
+                   failed_index,
+                   failed,
+                   NULL);
+            return state->error.kind;
+        }
+        argc = state->argc;
+        argv = state->argv;
+        STATS_PHASE(argParse, expand_ns, phase);
+    }
+
+    // 每个参数只扫描一次，之后的分派与查找都读取分类结果
+    if (!argParseTokenize(argParse)) {
+        __fail(argParse, ArgParseNOMEMORY, -1, NULL, NULL);
+        return state->error.kind;
+    }
 
-    CommandArgs *arg = NULL;
+    CommandArgs *arg      = NULL;
+    char        *attached = NULL;
 
     for (int i = 1; i < argc; i++) {
-        ArgType argType = checkArgType(argv[i]);
+        ArgType argType = state->tokens[i].type;
         switch (argType) {
         case COMMAND:
             // 处理命令
             i = __processCommand(argParse, argv[i], i);
             break;
-        case LONG_ARG: // 处理全局长选项
-            arg = argParseFindGlobalArgs(argParse, argv[i], false);
-            if (arg == NULL) {
-                char *msg =
-                    argParseGenerateArgErrorMsg(argParse, argv[i], false);
-                argParseError(argParse, argParse->current_command, msg, NULL);
-                return; // 错误处理
-            }
-            i = __processArgs(argParse, arg, i);
-            break;
+        case LONG_ARG:  // 处理全局长选项
         case SHORT_ARG: // 处理全局短选项
-            arg = argParseFindGlobalArgs(argParse, argv[i], true);
+            arg = __findOption(argParse, NULL, i, &attached);
             if (arg == NULL) {
-                char *msg =
-                    argParseGenerateArgErrorMsg(argParse, argv[i], true);
-                argParseError(argParse, argParse->current_command, msg, NULL);
-                return; // 错误处理
+                __fail(argParse,
+                       ArgParseUNKNOWNOPTION,
+                       i,
+                       argv[i],
+                       state->current_command);
+                return state->error.kind;
             }
             i = __processArgs(
-                argParse, arg, i); // 解析参数值并返回以解析到的索引位置
+                argParse, arg, i, attached); // 解析参数值并返回以解析到的索引位置
             break;
         default:
             break;
         }
+        if (i < 0) {
+            return state->error.kind;
+        }
     }
 
+    STATS_PHASE(argParse, dispatch_ns, phase);
+
     // 执行当前命令的回调函数
-    if (argParse->current_command != NULL &&
-        argParse->current_command->is_trigged &&
-        argParse->current_command->callback != NULL) {
-        argParse->current_command->callback(argParse,
-                                            argParse->current_command->val,
-                                            argParse->current_command->val_len);
+    Command *command = state->current_command;
+    if (command != NULL && command->callback != NULL) {
+        ArgParseSlot *slot = argParseSlotFind(&state->results, command);
+        if (slot != NULL && slot->is_trigged) {
+            command->callback(argParse, slot->val, slot->val_len);
+        }
     }
+    STATS_PHASE(argParse, callback_ns, phase);
 
     // 检查全局参数必填参数是否已设置
     for (int i = 0; i < argParse->global_args_len; i++) {
+        if (argParse->global_args[i]->required) {
+            STATS_ADD(required_checks, 1);
+        }
         if (argParse->global_args[i]->required &&
-            argParse->global_args[i]->is_trigged == false) {
+            !argParseIsTriggered(argParse, argParse->global_args[i])) {
             // 错误处理，必填全局参数未设置
-            char *msg =
-                stringNewCopy(RED "ERROR" RESET ": Global Option " BLUE);
-            if (argParse->global_args[i]->short_opt != NULL) {
-                __catStr(&msg, 1, argParse->global_args[i]->short_opt);
-            } else {
-                __catStr(&msg, 1, argParse->global_args[i]->long_opt);
-            }
-            __catStr(&msg, 1, RESET " is required");
-            argParseError(argParse, NULL, msg,
-                          NULL); // 错误处理
+            CommandArgs *arg = argParse->global_args[i];
+            __fail(argParse,
+                   ArgParseMISSINGREQUIRED,
+                   -1,
+                   arg->short_opt != NULL ? arg->short_opt : arg->long_opt,
+                   NULL);
+            return state->error.kind;
         }
     }
 
     // 检查当前命令的必填参数是否已设置
-    if (argParse->current_command != NULL) {
-        for (int i = 0; i < argParse->current_command->args_len; i++) {
-            if (argParse->current_command->args[i]->required &&
-                argParse->current_command->args[i]->is_trigged == false) {
+    if (state->current_command != NULL) {
+        for (int i = 0; i < state->current_command->args_len; i++) {
+            if (state->current_command->args[i]->required) {
+                STATS_ADD(required_checks, 1);
+            }
+            if (state->current_command->args[i]->required &&
+                !argParseIsTriggered(argParse,
+                                     state->current_command->args[i])) {
                 // 错误处理，必填参数未设置
-                char *msg = stringNewCopy(RED "ERROR" RESET ": Command " BLUE);
-                __catStr(&msg, 1, argParse->current_command->name);
-                __catStr(&msg, 1, RESET " Option " BLUE);
-                if (argParse->current_command->args[i]->short_opt != NULL) {
-                    __catStr(
-                        &msg, 1, argParse->current_command->args[i]->short_opt);
-                } else {
-                    __catStr(
-                        &msg, 1, argParse->current_command->args[i]->long_opt);
-                }
-                __catStr(&msg, 1, RESET " is required");
-                argParseError(
-                    argParse, argParse->current_command, msg, NULL); // 错误处理
+                CommandArgs *arg = state->current_command->args[i];
+                __fail(argParse,
+                       ArgParseMISSINGREQUIRED,
+                       -1,
+                       arg->short_opt != NULL ? arg->short_opt
+                                              : arg->long_opt,
+                       state->current_command);
+                return state->error.kind;
             }
         }
     }
+    STATS_PHASE(argParse, validate_ns, phase);
+
+    return state->error.kind;
+}
+
+/**
+ * @brief 解析命令行参数
+ * @errors: 默认打印错误与帮助后结束程序；关闭exit_on_error时只记录错误并返回
+ * @param argParse 解析器指针
+ * @param argc 参数个数
+ * @param argv 参数列表
+ * @return 成功返回ArgParseOK，否则为错误类型
+ */
+ArgParseErrorKind argParseParse(ArgParse *argParse, int argc, char *argv[]) {
+    ArgParseState *state = __state(argParse);
+    if (state == NULL) {
+        // 静态规格的解析状态分配失败，没有地方记录错误
+        if (argParse->exit_on_error) {
+            fputs("ERROR: Out of memory\n", stderr);
+            exit(1);
+        }
+        return ArgParseNOMEMORY;
+    }
+#ifdef ARGPARSE_STATS
+    // 构造规格的统计保留，解析部分每次重新开始
+    ArgParseStats *outer_stats  = argParseActiveStats;
+    size_t        *outer_allocs = argParseActiveAllocs;
+    ArgParseStats  stats        = {0};
+    stats.spec_ns               = state->stats.spec_ns;
+    stats.spec_allocs           = state->stats.spec_allocs;
+    state->stats                = stats;
+    argParseActiveStats         = &state->stats;
+    argParseActiveAllocs        = &state->stats.parse_allocs;
+
+    double            start = argParseNowNs();
+    ArgParseErrorKind kind  = __argParseParse(argParse, argc, argv);
+    state->stats.total_ns   = argParseNowNs() - start;
+
+    argParseActiveStats  = outer_stats;
+    argParseActiveAllocs = outer_allocs;
+    return kind;
+#else
+    return __argParseParse(argParse, argc, argv);
+#endif
+}
+
+const ArgParseErrorInfo *argParseGetError(ArgParse *argParse) {
+    if (argParse == NULL) {
+        return NULL;
+    }
+    return &__readState(argParse)->error;
+}
+
+bool argParseGetStats(ArgParse *argParse, ArgParseStats *stats) {
+    if (argParse == NULL || stats == NULL) {
+        return false;
+    }
+#ifdef ARGPARSE_STATS
+    *stats = __readState(argParse)->stats;
+    return true;
+#else
+    *stats = (ArgParseStats){0};
+    return false;
+#endif
+}
+
+// 节点的第一个值，未被解析到或无值时返回NULL
+static char *__slotValue(ArgParse *argParse, const void *node) {
+    ArgParseSlot *slot =
+        argParseSlotFind(&__readState(argParse)->results, node);
+    if (slot == NULL || slot->val_len < 1) {
+        return NULL;
+    }
+    return slot->val[0];
+}
+
+// 节点的值列表，未被解析到时长度为0
+static char **__slotValues(ArgParse *argParse, const void *node, int *len) {
+    ArgParseSlot *slot =
+        argParseSlotFind(&__readState(argParse)->results, node);
+    if (slot == NULL) {
+        *len = 0;
+        return NULL;
+    }
+    *len = slot->val_len;
+    return slot->val;
 }
 
 /**
@@ -636,10 +2649,11 @@ char *argParseGetCurCommandName(ArgParse *argParse) {
     if (argParse == NULL)
         return NULL;
 
-    if (argParse->current_command == NULL) {
+    Command *command = __readState(argParse)->current_command;
+    if (command == NULL) {
         return NULL;
     }
-    return argParse->current_command->name;
+    return command->name;
 }
 
 /**
@@ -650,22 +2664,14 @@ char *argParseGetCurCommandName(ArgParse *argParse) {
  * @return
  */
 char *argParseGetCurArg(ArgParse *argParse, const char *opt) {
-    CommandArgs *arg = NULL;
-    // 尝试获取当前命令的长选项参数
-    arg = argParseFindCommandArgs(argParse->current_command, opt, false);
-
-    if (arg == NULL) {
-        // 尝试获取当前命令的短选项参数
-        arg = argParseFindCommandArgs(argParse->current_command, opt, true);
-    }
+    // 长短选项名共用一个索引，一次查找即可
+    CommandArgs *arg = argParseFindCommandArgs(
+        __readState(argParse)->current_command, opt, NULL);
 
     if (arg == NULL) {
         return NULL;
     }
-    if (arg->val_len >= 1) {
-        return arg->val[0];
-    }
-    return NULL;
+    return __slotValue(argParse, arg);
 }
 
 /**
@@ -676,18 +2682,13 @@ char *argParseGetCurArg(ArgParse *argParse, const char *opt) {
  * @return char** 参数列表
  */
 char **argParseGetCurArgList(ArgParse *argParse, const char *opt, int *len) {
-    CommandArgs *arg = NULL;
-    arg = argParseFindCommandArgs(argParse->current_command, opt, false);
-
-    if (arg == NULL) {
-        arg = argParseFindCommandArgs(argParse->current_command, opt, true);
-    }
+    CommandArgs *arg = argParseFindCommandArgs(
+        __readState(argParse)->current_command, opt, NULL);
 
     if (arg == NULL) {
         return NULL;
     }
-    *len = arg->val_len;
-    return arg->val;
+    return __slotValues(argParse, arg, len);
 }
 
 /**
@@ -697,20 +2698,12 @@ char **argParseGetCurArgList(ArgParse *argParse, const char *opt, int *len) {
  * @return char* 选项值
  */
 char *argParseGetGlobalArg(ArgParse *argParse, const char *opt) {
-    CommandArgs *arg = NULL;
-    arg              = argParseFindGlobalArgs(argParse, opt, false);
-
-    if (arg == NULL) {
-        arg = argParseFindGlobalArgs(argParse, opt, true);
-    }
+    CommandArgs *arg = argParseFindGlobalArgs(argParse, opt, NULL);
 
     if (arg == NULL) {
         return NULL;
     }
-    if (arg->val_len >= 1) {
-        return arg->val[0];
-    }
-    return NULL;
+    return __slotValue(argParse, arg);
 }
 
 /**
@@ -718,27 +2711,26 @@ char *argParseGetGlobalArg(ArgParse *argParse, const char *opt) {
  * @return  char* 参数值
  */
 char *argParseGetCurCommandValue(ArgParse *argParse) {
-    Command *command = argParse->current_command;
+    Command *command = __readState(argParse)->current_command;
     if (command == NULL) {
         return NULL;
     }
-    if (command->val_len >= 1) {
-        return command->val[0];
-    }
-    return NULL;
+    return __slotValue(argParse, command);
 }
 /**
  * @brief 获取当前解析到的命令参数列表,仅适用于多值参数
  * @return char** 参数列表
  */
 char **argParseGetCurCommandValues(ArgParse *argParse, int *len) {
-    Command *command = argParse->current_command;
-    if (command == NULL) {
+    const ArgParseState *state = __readState(argParse);
+    ArgParseSlot        *slot =
+        argParseSlotFind(&state->results, state->current_command);
+    if (slot == NULL) {
         return NULL;
     }
-    if (command->val_len >= 1) {
-        *len = command->val_len;
-        return command->val;
+    if (slot->val_len >= 1) {
+        *len = slot->val_len;
+        return slot->val;
     }
     return NULL;
 }
@@ -751,18 +2743,12 @@ char **argParseGetCurCommandValues(ArgParse *argParse, int *len) {
  * @return char** 参数列表
  */
 char **argParseGetGlobalArgList(ArgParse *argParse, const char *opt, int *len) {
-    CommandArgs *arg = NULL;
-    arg              = argParseFindGlobalArgs(argParse, opt, false);
-
-    if (arg == NULL) {
-        arg = argParseFindGlobalArgs(argParse, opt, true);
-    }
+    CommandArgs *arg = argParseFindGlobalArgs(argParse, opt, NULL);
 
     if (arg == NULL) {
         return NULL;
     }
-    *len = arg->val_len;
-    return arg->val;
+    return __slotValues(argParse, arg, len);
 }
 
 char **argParseGetValList(ArgParse *argParse, int *len) {
@@ -770,11 +2756,12 @@ char **argParseGetValList(ArgParse *argParse, int *len) {
         return NULL;
     }
 
-    if (argParse->val_len == 0) {
+    const ArgParseState *state = __readState(argParse);
+    if (state->val_len == 0) {
         return NULL;
     }
-    *len = argParse->val_len;
-    return argParse->val;
+    *len = state->val_len;
+    return state->val;
 }
 
 char *argParseGetVal(ArgParse *argParse) {
@@ -782,92 +2769,358 @@ char *argParseGetVal(ArgParse *argParse) {
         return NULL;
     }
 
-    if (argParse->val_len == 0) {
+    const ArgParseState *state = __readState(argParse);
+    if (state->val_len == 0) {
         return NULL;
     }
-    return argParse->val[0];
+    return state->val[0];
 }
 
-char *argParseGenerateHelpForCommand(Command *command) {
-    if (command == NULL) {
-        return NULL;
-    }
+typedef struct HelpStyle {
+    const char *usage;   // Usage标题
+    const char *heading; // 分节标题
+    const char *name;    // 命令与选项名
+    const char *reset;   // 恢复默认样式
+} HelpStyle;             // 帮助信息中的颜色控制序列
 
-    char *help_msg = stringNewCopy(command->help);
-    if (help_msg == NULL) {
-        return NULL;
-    }
+// 下标为是否带颜色，无颜色时各序列均为空串
+static const HelpStyle _HelpStyles[2] = {
+    {"", "", "", ""},
+    {"\033[1;33m", "\033[1;34m", "\033[1;32m", "\033[0m"},
+};
 
-    __catStr(&help_msg, 1, "\n\n");
-    __catStr(&help_msg, 2, "\033[1;33mUsage\033[0m: ", command->name);
+/**
+ * @brief 按指定样式输出命令帮助信息
+ * @param command 命令指针，help不为NULL
+ * @param style 颜色样式
+ * @param out 输出目标
+ */
+static void __emitCommandHelp(const Command   *command,
+                              const HelpStyle *style,
+                              TextSink        *out) {
+    textSinkAppend(out,
+                   7,
+                   command->help,
+                   "\n\n",
+                   style->usage,
+                   "Usage",
+                   style->reset,
+                   ": ",
+                   command->name);
 
     switch (command->value_type) {
     case ArgParseNOVALUE:
         break;
     case ArgParseSINGLEVALUE:
-        __catStr(&help_msg, 1, " <value>");
+        textSinkAppend(out, 1, " <value>");
         break;
     case ArgParseMULTIVALUE:
-        __catStr(&help_msg, 1, " <value>...");
+        textSinkAppend(out, 1, " <value>...");
     }
 
     if (command->args != NULL) {
-        __catStr(&help_msg, 1, " [Options]");
-        __catStr(&help_msg, 1, "\n\n\033[1;34mOptions\033[0m:");
+        textSinkAppend(out,
+                       6,
+                       " [Options]",
+                       "\n\n",
+                       style->heading,
+                       "Options",
+                       style->reset,
+                       ":");
         for (int i = 0; i < command->args_len; i++) {
             CommandArgs *arg = command->args[i];
 
-            __catStr(&help_msg,
-                     6,
-                     "\n  \033[1;32m",
-                     arg->short_opt,
-                     "\033[0m , \033[1;32m",
-                     arg->long_opt,
-                     "\033[0m  ",
-                     arg->help);
+            textSinkAppend(out,
+                           10,
+                           "\n  ",
+                           style->name,
+                           arg->short_opt,
+                           style->reset,
+                           " , ",
+                           style->name,
+                           arg->long_opt,
+                           style->reset,
+                           "  ",
+                           arg->help);
+        }
+    }
+    textSinkAppend(out, 1, "\n");
+}
+
+/**
+ * @brief 按指定样式输出全局帮助信息
+ * @param argParse 解析器指针，documentation不为NULL
+ * @param style 颜色样式
+ * @param out 输出目标
+ */
+static void __emitGlobalHelp(const ArgParse  *argParse,
+                             const HelpStyle *style,
+                             TextSink        *out) {
+    textSinkAppend(out,
+                   6,
+                   argParse->documentation,
+                   "\n\n",
+                   style->heading,
+                   "Commands",
+                   style->reset,
+                   ":");
+    for (int i = 0; i < argParse->commands_len; i++) {
+        Command *command = argParse->commands[i];
+
+        textSinkAppend(out,
+                       6,
+                       "\n  ",
+                       style->name,
+                       command->name,
+                       style->reset,
+                       "  ",
+                       command->help);
+    }
+
+    if (argParse->global_args_len > 0) {
+        textSinkAppend(out,
+                       5,
+                       "\n\n",
+                       style->heading,
+                       "Global Options",
+                       style->reset,
+                       ":");
+        for (int i = 0; i < argParse->global_args_len; i++) {
+            CommandArgs *arg = argParse->global_args[i];
+
+            textSinkAppend(out,
+                           10,
+                           "\n  ",
+                           style->name,
+                           arg->short_opt,
+                           style->reset,
+                           " , ",
+                           style->name,
+                           arg->long_opt,
+                           style->reset,
+                           "  ",
+                           arg->help);
         }
     }
-    __catStr(&help_msg, 1, "\n");
+}
 
-    return help_msg;
+// 是否有帮助信息可以输出，command为NULL时为全局帮助
+static bool __hasHelp(const ArgParse *argParse, const Command *command) {
+    if (command != NULL) {
+        return command->help != NULL;
+    }
+    return argParse != NULL && argParse->documentation != NULL;
 }
 
-//  检查全局参数是否被触发
-bool argParseCheckGlobalTriggered(ArgParse *argParse, const char *opt) {
-    CommandArgs *arg = NULL;
-    arg              = argParseFindGlobalArgs(argParse, opt, false);
+/**
+ * @brief 生成帮助信息字符串
+ * @param argParse 解析器指针，command不为NULL时可为NULL
+ * @param command 命令指针，为NULL时为全局帮助
+ * @param style 颜色样式
+ * @param len 返回帮助信息长度，可为NULL
+ * @return 没有帮助信息或内存分配失败时为NULL，否则由调用方用argParseHeapFree释放
+ */
+static char *__helpString(const ArgParse  *argParse,
+                          const Command   *command,
+                          const HelpStyle *style,
+                          size_t          *len) {
+    if (!__hasHelp(argParse, command)) {
+        return NULL;
+    }
+    __buildCommand((Command *)command);
 
-    if (arg == NULL) {
-        arg = argParseFindGlobalArgs(argParse, opt, true);
+    StrBuilder help_msg;
+    TextSink   out;
+    strBuilderInit(&help_msg);
+    textSinkInitBuilder(&out, &help_msg);
+    if (command != NULL) {
+        __emitCommandHelp(command, style, &out);
+    } else {
+        __emitGlobalHelp(argParse, style, &out);
+    }
+    if (!out.ok) {
+        strBuilderFree(&help_msg);
+        return NULL;
     }
 
-    if (arg == NULL) {
+    if (len != NULL) {
+        *len = help_msg.len;
+    }
+    return strBuilderDetach(&help_msg);
+}
+
+char *argParseGenerateHelpForCommand(Command *command) {
+    return __helpString(NULL, command, &_HelpStyles[1], NULL);
+}
+
+char *argParseGenerateHelp(ArgParse *argParse) {
+    return __helpString(argParse, NULL, &_HelpStyles[1], NULL);
+}
+
+/**
+ * @brief 查找命令的帮助缓存条目
+ * 条目数不超过命令数加一，线性查找即可
+ * @param argParse 解析器指针
+ * @param command 命令指针，全局帮助为NULL
+ * @param create 不存在时是否追加一个空条目
+ * @return 缓存条目，不存在且不创建或内存分配失败时返回NULL
+ */
+static ArgParseHelpEntry *
+__helpEntry(ArgParse *argParse, const Command *command, bool create) {
+    // 静态规格的解析状态按需分配，只查找时不必为其分配
+    ArgParseState *state = create ? __state(argParse) : argParse->state;
+    if (state == NULL) {
+        return NULL;
+    }
+    ArgParseHelpCache *cache = &state->help_cache;
+    for (int i = 0; i < cache->len; i++) {
+        if (cache->entries[i].command == command) {
+            return &cache->entries[i];
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    if (cache->len == cache->cap) {
+        int                cap     = cache->cap == 0 ? 4 : cache->cap * 2;
+        ArgParseHelpEntry *entries = argParseHeapRealloc(
+            cache->entries, cap * sizeof(ArgParseHelpEntry));
+        if (entries == NULL) {
+            return NULL;
+        }
+        cache->entries = entries;
+        cache->cap     = cap;
+    }
+
+    ArgParseHelpEntry entry    = {command, {NULL, NULL}, {0, 0}};
+    cache->entries[cache->len] = entry;
+    return &cache->entries[cache->len++];
+}
+
+const char *argParseGetHelp(ArgParse      *argParse,
+                            const Command *command,
+                            bool           color,
+                            size_t        *len) {
+    if (len != NULL) {
+        *len = 0;
+    }
+    if (argParse == NULL) {
+        return NULL;
+    }
+
+    __buildCommand((Command *)command); // 构造时会清空帮助缓存，需在查找之前
+    ArgParseHelpEntry *entry = __helpEntry(argParse, command, true);
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    int variant = color ? 1 : 0;
+    if (entry->text[variant] == NULL) {
+        entry->text[variant] = __helpString(
+            argParse, command, &_HelpStyles[variant], &entry->len[variant]);
+    }
+
+    if (len != NULL) {
+        *len = entry->len[variant];
+    }
+    return entry->text[variant];
+}
+
+const char *argParseResultGetHelp(ArgParseResult *result,
+                                  const Command  *command,
+                                  bool            color,
+                                  size_t         *len) {
+    if (result == NULL) {
+        if (len != NULL) {
+            *len = 0;
+        }
+        return NULL;
+    }
+    return argParseGetHelp(&result->view, command, color, len);
+}
+
+/**
+ * @brief 输出帮助信息，已缓存时输出缓存，否则边生成边输出，不分配内存
+ * @param argParse 解析器指针，command不为NULL时可为NULL
+ * @param command 命令指针，为NULL时为全局帮助
+ * @param color 是否包含颜色控制序列
+ * @param out 输出目标
+ */
+static void __writeHelp(ArgParse      *argParse,
+                        const Command *command,
+                        bool           color,
+                        TextSink      *out) {
+    if (!__hasHelp(argParse, command)) {
+        return;
+    }
+    __buildCommand((Command *)command); // 构造时会清空帮助缓存，需在查找之前
+
+    int                variant = color ? 1 : 0;
+    ArgParseHelpEntry *entry =
+        argParse != NULL ? __helpEntry(argParse, command, false) : NULL;
+    if (entry != NULL && entry->text[variant] != NULL) {
+        textSinkAppend(out, 1, entry->text[variant]);
+    } else if (command != NULL) {
+        __emitCommandHelp(command, &_HelpStyles[variant], out);
+    } else {
+        __emitGlobalHelp(argParse, &_HelpStyles[variant], out);
+    }
+}
+
+bool argParseWriteHelp(ArgParse      *argParse,
+                       const Command *command,
+                       bool           color,
+                       int            fd) {
+    if (!__hasHelp(argParse, command)) {
         return false;
     }
-    return arg->is_trigged;
+    TextSink out;
+    textSinkInitFd(&out, fd);
+    __writeHelp(argParse, command, color, &out);
+    return textSinkFlush(&out);
 }
-// 检测当前命令的某项参数是否被触发
-bool argParseCheckCurArgTriggered(ArgParse *argParse, const char *opt) {
-    CommandArgs *arg = NULL;
-    arg = argParseFindCommandArgs(argParse->current_command, opt, false);
+
+bool argParsePrintHelp(ArgParse      *argParse,
+                       const Command *command,
+                       bool           color,
+                       FILE          *stream) {
+    if (!__hasHelp(argParse, command) || stream == NULL) {
+        return false;
+    }
+    TextSink out;
+    textSinkInitFile(&out, stream);
+    __writeHelp(argParse, command, color, &out);
+    return textSinkFlush(&out);
+}
+
+//  检查全局参数是否被触发
+bool argParseCheckGlobalTriggered(ArgParse *argParse, const char *opt) {
+    CommandArgs *arg = argParseFindGlobalArgs(argParse, opt, NULL);
 
     if (arg == NULL) {
-        arg = argParseFindCommandArgs(argParse->current_command, opt, true);
+        return false;
     }
+    return argParseIsTriggered(argParse, arg);
+}
+// 检测当前命令的某项参数是否被触发
+bool argParseCheckCurArgTriggered(ArgParse *argParse, const char *opt) {
+    CommandArgs *arg = argParseFindCommandArgs(
+        __readState(argParse)->current_command, opt, NULL);
 
     if (arg == NULL) {
         return false;
     }
-    return arg->is_trigged;
+    return argParseIsTriggered(argParse, arg);
 }
 // 检测指定命令是否被触发
 bool argParseCheckCommandTriggered(ArgParse   *argParse,
                                    const char *command_name) {
-    Command *command = argParseFindCommand(argParse, command_name);
+    Command *command = argParseFindCommand(argParse, command_name, NULL);
     if (command == NULL) {
         return false;
     }
-    return command->is_trigged;
+    return argParseIsTriggered(argParse, command);
 }
 
 NORETURN void argParseError(ArgParse   *argParse,
@@ -878,48 +3131,21 @@ NORETURN void argParseError(ArgParse   *argParse,
         printf("ERROR: Parse is NULL\n");
         exit(1);
     }
-    if (lastCommand == NULL) {
-        char *mgs = stringNewCopy("");
-        if (prefix != NULL) {
-            __catStr(&mgs, 1, prefix);
-        }
-        char *help = argParseGenerateHelp(argParse);
-
-        if (help != NULL) {
-            __catStr(&mgs, 2, "\n", help);
-        }
-
-        if (suffix != NULL) {
-            __catStr(&mgs, 2, "\n", suffix);
-        }
-
-        printf("%s\n", mgs);
-        free(mgs);
-        free(help);
-        argParseFree(argParse);
-        exit(1);
-    }
-
-    char *ErrorMsg = NULL;
-
-    if (prefix != NULL) {
-        ErrorMsg = stringNewCopy((char *)prefix);
-    }
-
-    char *command_help_msg     = argParseGenerateHelpForCommand(lastCommand);
-    int   command_help_msg_len = strlen(command_help_msg);
 
-    if (command_help_msg != NULL) {
-        __catStr(&ErrorMsg, 2, "\n", command_help_msg);
+    // 各片段直接写入标准输出，不拼接中间字符串
+    TextSink out;
+    textSinkInitFile(&out, stdout);
+    textSinkAppend(&out, 1, prefix);
+    if (__hasHelp(argParse, lastCommand)) {
+        textSinkAppend(&out, 1, "\n");
+        __writeHelp(argParse, lastCommand, argParse->color, &out);
     }
-
     if (suffix != NULL) {
-        __catStr(&ErrorMsg, 2, "\n", suffix);
+        textSinkAppend(&out, 2, "\n", suffix);
     }
+    textSinkAppend(&out, 1, "\n");
+    textSinkFlush(&out);
 
-    printf("%s\n", ErrorMsg);
-    free(ErrorMsg);
-    free(command_help_msg);
     argParseFree(argParse);
     exit(1);
 }
@@ -934,67 +3160,25 @@ char *argParseGenerateArgErrorMsg(ArgParse   *argParse,
         return NULL;
     }
 
-    char *ErrorMsg = NULL;
-
-    if (_COLOR) {
-        ErrorMsg = stringNewCopy("\033[1;31mERROR\033[0m: Invalid argument ");
-    } else {
-        ErrorMsg = stringNewCopy("ERROR: Invalid argument ");
-    }
+    StrBuilder ErrorMsg;
+    strBuilderInit(&ErrorMsg);
 
-    if (short_flag) {
-        __catStr(&ErrorMsg, 1, name);
+    if (argParse->color) {
+        strBuilderAppend(
+            &ErrorMsg, 1, "\033[1;31mERROR\033[0m: Invalid argument ");
     } else {
-        __catStr(&ErrorMsg, 1, name);
-    }
-    return ErrorMsg;
-}
-
-char *argParseGenerateHelp(ArgParse *argParse) {
-    if (argParse == NULL) {
-        return NULL;
-    }
-
-    char *help_msg = stringNewCopy(argParse->documentation);
-
-    if (help_msg == NULL) {
-        return NULL;
-    }
-
-    __catStr(&help_msg, 1, "\n\n\033[1;34mCommands\033[0m:");
-    for (int i = 0; i < argParse->commands_len; i++) {
-        Command *command = argParse->commands[i];
-
-        __catStr(&help_msg,
-                 4,
-                 "\n  \033[1;32m",
-                 command->name,
-                 "\033[0m  ",
-                 command->help);
-    }
-
-    if (argParse->global_args_len > 0) {
-        __catStr(&help_msg, 1, "\n\n\033[1;34mGlobal Options\033[0m:");
-        for (int i = 0; i < argParse->global_args_len; i++) {
-            CommandArgs *arg = argParse->global_args[i];
-
-            __catStr(&help_msg,
-                     6,
-                     "\n  \033[1;32m",
-                     arg->short_opt,
-                     "\033[0m , \033[1;32m",
-                     arg->long_opt,
-                     "\033[0m  ",
-                     arg->help);
-        }
+        strBuilderAppend(&ErrorMsg, 1, "ERROR: Invalid argument ");
     }
 
-    return help_msg;
+    strBuilderAppend(&ErrorMsg, 1, name);
+    return strBuilderDetach(&ErrorMsg);
 }
 
 _Noreturn void argParseHelp(ArgParse *argParse) {
-    char *help_msg = argParseGenerateHelp(argParse);
-    printf("%s\n", help_msg);
-    free(help_msg);
+    TextSink out;
+    textSinkInitFile(&out, stdout);
+    __writeHelp(argParse, NULL, argParse->color, &out);
+    textSinkAppend(&out, 1, "\n");
+    textSinkFlush(&out);
     exit(0);
 }
\ No newline at end of file
@@ -3,9 +3,74 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <sched.h>
+#ifdef ARGPARSE_THREADS
+#include <pthread.h>
+#endif
+#else
+#include <io.h>
+#include <windows.h>
+#endif
+#include <errno.h>
+
+#ifdef ARGPARSE_STATS
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+THREAD_LOCAL ArgParseStats *argParseActiveStats  = NULL;
+THREAD_LOCAL size_t        *argParseActiveAllocs = NULL;
+
+double argParseNowNs() {
+#ifdef _WIN32
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief 进入构造规格的API，耗时与分配计入该解析器的spec统计
+ * 嵌套调用(例如添加命令时自动添加帮助参数)以及解析期间的调用沿用外层的统计
+ * @param argParse 解析器，可为NULL
+ * @return 离开时传给argParseSpecEnd的范围
+ */
+ArgParseStatsScope argParseSpecBegin(ArgParse *argParse) {
+    ArgParseStatsScope scope = {NULL, argParseActiveAllocs, 0};
+    // 静态规格不能构造，也可能还没有解析状态
+    if (argParse != NULL && argParse->state != NULL &&
+        argParseActiveAllocs == NULL) {
+        scope.target         = &argParse->state->stats;
+        scope.start          = argParseNowNs();
+        argParseActiveAllocs = &argParse->state->stats.spec_allocs;
+    }
+    return scope;
+}
+
+void argParseSpecEnd(ArgParseStatsScope scope) {
+    if (scope.target != NULL) {
+        scope.target->spec_ns += argParseNowNs() - scope.start;
+    }
+    argParseActiveAllocs = scope.allocs;
+}
+#endif
+
 /**
  * @brief 分配新内存复制字符串
  * @param str 字符串
@@ -15,7 +80,7 @@ char *stringNewCopy(const char *str) {
     if (str == NULL) {
         return NULL;
     }
-    char *mem = malloc(strlen(str) + 1);
+    char *mem = argParseHeapAlloc(strlen(str) + 1);
     if (mem == NULL) {
         return NULL;
     }
@@ -23,33 +88,346 @@ char *stringNewCopy(const char *str) {
     return mem;
 }
 
+/** Start----------------内存分配---------------- */
+
+#define ARENA_BLOCK_SIZE (64 * 1024) // 内存池默认块大小
+#define ARENA_ALIGN      _Alignof(max_align_t)
+
+typedef struct ArgParseArenaBlock {
+    struct ArgParseArenaBlock *next; // 下一个块
+    size_t                     size; // 块可用大小
+    size_t                     used; // 已使用大小
+} ArgParseArenaBlock;
+
+struct ArgParseArena {
+    ArgParseArenaBlock *head; // 当前块，旧块链在其后
+};
+
+static void *__libcMalloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void *__libcRealloc(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    return realloc(ptr, size);
+}
+
+static void __libcFree(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+typedef struct ArgParseAllocator {
+    ArgParseMallocFn  malloc_fn;  // 分配函数
+    ArgParseReallocFn realloc_fn; // 重新分配函数
+    ArgParseFreeFn    free_fn;    // 释放函数
+    void             *ctx;        // 上下文
+} ArgParseAllocator;
+
+// 库内全部堆内存的分配器，默认使用标准库
+static ArgParseAllocator _Allocator = {
+    __libcMalloc, __libcRealloc, __libcFree, NULL};
+
+// 计数分配器的统计，为NULL时不计数也不附加头部
+static ArgParseAllocStats *_Counting = NULL;
+
+// 计数分配器在每块内存前记录大小，按最大对齐保证返回的地址仍然对齐
+typedef union CountingHeader {
+    size_t      size;
+    max_align_t align;
+} CountingHeader;
+
+void argParseSetAllocator(ArgParseMallocFn  malloc_fn,
+                          ArgParseReallocFn realloc_fn,
+                          ArgParseFreeFn    free_fn,
+                          void             *ctx) {
+    if (malloc_fn == NULL || realloc_fn == NULL || free_fn == NULL) {
+        _Allocator =
+            (ArgParseAllocator){__libcMalloc, __libcRealloc, __libcFree, NULL};
+        return;
+    }
+    _Allocator = (ArgParseAllocator){malloc_fn, realloc_fn, free_fn, ctx};
+}
+
+void argParseUseCountingAllocator(ArgParseAllocStats *stats) {
+    _Counting = stats;
+    if (stats != NULL) {
+        *stats = (ArgParseAllocStats){0, 0, 0, 0};
+    }
+}
+
+void argParseAllocStatsBegin(ArgParseAllocStats *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->count      = 0;
+    stats->base_bytes = stats->bytes;
+    stats->peak_bytes = 0;
+}
+
+// 记录一次分配并更新区间峰值
+static void __countAlloc(size_t size) {
+    _Counting->count++;
+    _Counting->bytes += size;
+    if (_Counting->bytes > _Counting->base_bytes &&
+        _Counting->bytes - _Counting->base_bytes > _Counting->peak_bytes) {
+        _Counting->peak_bytes = _Counting->bytes - _Counting->base_bytes;
+    }
+}
+
+/**
+ * @brief 经由设置的分配器分配堆内存，库内不直接调用malloc
+ * @param size 大小
+ * @return 内存指针
+ */
+void *argParseHeapAlloc(size_t size) {
+    STATS_ALLOC();
+    if (_Counting == NULL) {
+        return _Allocator.malloc_fn(_Allocator.ctx, size);
+    }
+    CountingHeader *header =
+        _Allocator.malloc_fn(_Allocator.ctx, sizeof(CountingHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->size = size;
+    __countAlloc(size);
+    return header + 1;
+}
+
+/**
+ * @brief 经由设置的分配器重新分配堆内存
+ * @param ptr 原内存，为NULL时等同argParseHeapAlloc
+ * @param size 新大小
+ * @return 内存指针，失败时原内存保持不变
+ */
+void *argParseHeapRealloc(void *ptr, size_t size) {
+    STATS_ALLOC();
+    if (_Counting == NULL) {
+        return _Allocator.realloc_fn(_Allocator.ctx, ptr, size);
+    }
+    if (ptr == NULL) {
+        return argParseHeapAlloc(size);
+    }
+    CountingHeader *header   = (CountingHeader *)ptr - 1;
+    size_t          old_size = header->size;
+    header                   = _Allocator.realloc_fn(
+        _Allocator.ctx, header, sizeof(CountingHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->size      = size;
+    _Counting->bytes -= old_size;
+    __countAlloc(size);
+    return header + 1;
+}
+
+// 经由设置的分配器释放堆内存
+void argParseHeapFree(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    if (_Counting != NULL) {
+        CountingHeader *header  = (CountingHeader *)ptr - 1;
+        _Counting->bytes       -= header->size;
+        ptr                     = header;
+    }
+    _Allocator.free_fn(_Allocator.ctx, ptr);
+}
+
+static size_t __alignSize(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+static ArgParseArenaBlock *__arenaNewBlock(size_t size) {
+    size_t              header = __alignSize(sizeof(ArgParseArenaBlock));
+    ArgParseArenaBlock *block  = argParseHeapAlloc(header + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->next = NULL;
+    block->size = size;
+    block->used = header;
+    return block;
+}
+
+/**
+ * @brief 创建内存池，池结构本身放在第一个块中
+ * @return 内存池指针
+ */
+ArgParseArena *argParseArenaCreate() {
+    ArgParseArenaBlock *block = __arenaNewBlock(ARENA_BLOCK_SIZE);
+    if (block == NULL) {
+        return NULL;
+    }
+    ArgParseArena *arena = (ArgParseArena *)((char *)block + block->used);
+    block->used += __alignSize(sizeof(ArgParseArena));
+    arena->head = block;
+    return arena;
+}
+
+/**
+ * @brief 从内存池中按顺序分配内存
+ * @param arena 内存池
+ * @param size 大小
+ * @return 内存指针
+ */
+void *argParseArenaAlloc(ArgParseArena *arena, size_t size) {
+    size = __alignSize(size == 0 ? 1 : size);
+    ArgParseArenaBlock *block = arena->head;
+    if (block->used + size > block->size) {
+        // 超大请求单独成块，避免浪费当前块剩余空间
+        size_t block_size = size > ARENA_BLOCK_SIZE / 4
+                                ? size + __alignSize(sizeof(ArgParseArenaBlock))
+                                : ARENA_BLOCK_SIZE;
+        ArgParseArenaBlock *new_block = __arenaNewBlock(block_size);
+        if (new_block == NULL) {
+            return NULL;
+        }
+        if (size > ARENA_BLOCK_SIZE / 4) {
+            // 插到当前块之后，当前块继续服务小请求
+            new_block->next = block->next;
+            block->next     = new_block;
+            new_block->used += size;
+            return (char *)new_block + new_block->used - size;
+        }
+        new_block->next = block;
+        arena->head     = new_block;
+        block           = new_block;
+    }
+    void *mem = (char *)block + block->used;
+    block->used += size;
+    return mem;
+}
+
+/**
+ * @brief 释放内存池的全部块，池结构本身也随之释放
+ * @param arena 内存池
+ */
+void argParseArenaDestroy(ArgParseArena *arena) {
+    if (arena == NULL) {
+        return;
+    }
+    ArgParseArenaBlock *block = arena->head;
+    while (block != NULL) {
+        ArgParseArenaBlock *next = block->next;
+        argParseHeapFree(block);
+        block = next;
+    }
+}
+
+/**
+ * @brief 为解析器分配内存，内存池模式下从池中分配
+ * @param argParse 解析器
+ * @param size 大小
+ * @return 内存指针
+ */
+void *argParseMemAlloc(ArgParse *argParse, size_t size) {
+    if (argParse != NULL && argParse->arena != NULL) {
+        return argParseArenaAlloc(argParse->arena, size);
+    }
+    return argParseHeapAlloc(size);
+}
+
+/**
+ * @brief 重新分配内存，内存池模式下分配新内存并复制旧内容
+ * @param argParse 解析器
+ * @param ptr 原内存
+ * @param old_size 原大小
+ * @param size 新大小
+ * @return 内存指针，失败时原内存保持不变
+ */
+void *argParseMemRealloc(ArgParse *argParse,
+                         void     *ptr,
+                         size_t    old_size,
+                         size_t    size) {
+    if (argParse != NULL && argParse->arena != NULL) {
+        void *mem = argParseArenaAlloc(argParse->arena, size);
+        if (mem != NULL && ptr != NULL) {
+            memcpy(mem, ptr, old_size < size ? old_size : size);
+        }
+        return mem;
+    }
+    return argParseHeapRealloc(ptr, size);
+}
+
+// 释放内存，内存池模式下由argParseFree统一回收
+void argParseMemFree(ArgParse *argParse, void *ptr) {
+    if (argParse != NULL && argParse->arena != NULL) {
+        return;
+    }
+    argParseHeapFree(ptr);
+}
+
+// 在解析器内存中复制字符串
+char *argParseMemStrCopy(ArgParse *argParse, const char *str) {
+    if (str == NULL) {
+        return NULL;
+    }
+    size_t len = strlen(str) + 1;
+    char  *mem = argParseMemAlloc(argParse, len);
+    if (mem == NULL) {
+        return NULL;
+    }
+    memcpy(mem, str, len);
+    return mem;
+}
+
+/**
+ * @brief 为追加一个元素准备指针数组，容量隐含为不小于长度的2的幂
+ * @param argParse 解析器
+ * @param array 原数组
+ * @param len 当前元素个数
+ * @param elem_size 元素大小
+ * @return 可容纳len+1个元素的数组，失败返回NULL
+ */
+void *
+argParseMemGrow(ArgParse *argParse, void *array, int len, size_t elem_size) {
+    if (array != NULL && (len < 4 || (len & (len - 1)) != 0)) {
+        return array; // 未到容量边界
+    }
+    size_t capacity = len < 4 ? 4 : (size_t)len * 2;
+    return argParseMemRealloc(
+        argParse, array, (size_t)len * elem_size, capacity * elem_size);
+}
+
+/** End----------------内存分配---------------- */
+
 // 构造命令
-Command *createCommand(const char       *name,
+Command *createCommand(ArgParse         *argParse,
+                       const char       *name,
                        const char       *help,
                        const char       *default_val,
                        ArgParseCallback  callback,
                        CommandGroup     *group,
                        ArgParseValueType value_typ) {
     // 构造命令结构
-    Command *command = malloc(sizeof(Command));
+    Command *command = argParseMemAlloc(argParse, sizeof(Command));
     if (command == NULL || name == NULL) {
         return NULL;
     }
 
-    command->name = stringNewCopy(name);
+    command->parser = argParse;
+    command->name   = argParseMemStrCopy(argParse, name);
     if (command->name == NULL) {
         return NULL;
     }
 
-    command->help             = stringNewCopy(help);
-    command->default_val      = stringNewCopy(default_val);
-    command->callback         = callback;
+    command->help               = argParseMemStrCopy(argParse, help);
+    command->default_val        = argParseMemStrCopy(argParse, default_val);
+    command->callback           = callback;
 
-    command->sub_commands     = NULL;
-    command->sub_commands_len = 0;
-    command->args             = NULL;
-    command->args_len         = 0;
-    command->value_type       = value_typ;
+    command->sub_commands       = NULL;
+    command->sub_commands_len   = 0;
+    command->sub_commands_index = NULL;
+    command->args               = NULL;
+    command->args_len           = 0;
+    command->args_index         = NULL;
+    command->value_type         = value_typ;
+    command->builder            = NULL;
+    command->builder_ctx        = NULL;
+    command->build_state        = 0;
 
     if (group != NULL) {
         command->group = group;
@@ -57,272 +435,1562 @@ Command *createCommand(const char       *name,
         command->group = NULL;
     }
 
-    command->val        = NULL;
-    command->val_len    = 0;
-    command->is_trigged = false; // 是否被触发
     return command;
 }
 
-ArgType checkArgType(char *arg) {
-    size_t len = strlen(arg);
-    if (len == 0) {
-        return BAD;
+#define FNV_OFFSET 2166136261u // FNV-1a初始值
+#define FNV_PRIME  16777619u   // FNV-1a乘数
+
+/** Start----------------参数分类---------------- */
+
+/*
+ * 类型只由前两个字节决定；长度与长选项中'='的位置由下面按指令集分级的批量扫描求出。
+ * 向量版本从按16/32字节对齐的地址整块读取，对齐的读取不会跨页，
+ * 读到字符串之外的字节只参与比较、不影响结果，因此对检测工具关闭越界检查。
+ * 哈希在参数首次被用作查找键时才计算，数量最多的值参数不需要哈希
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+#endif
+#ifndef NO_SANITIZE_ADDRESS
+#if defined(__GNUC__) && defined(__SANITIZE_ADDRESS__)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define NO_SANITIZE_ADDRESS
+#endif
+#endif
+
+// 由前两个字节得到参数类型，不会读到'\0'之后
+static inline ArgType __tokenType(const char *arg) {
+    if (arg[0] != '-') {
+        return arg[0] == '\0' ? BAD : COMMAND;
     }
-    if (arg[0] == '-') {
-        if (len >= 2) {
-            if (arg[1] == '-') {
-                return LONG_ARG;
-            } else {
-                return SHORT_ARG;
-            }
-        }
-    } else {
-        return COMMAND;
+    if (arg[1] == '\0') {
+        return BAD;
     }
-    return BAD;
+    return arg[1] == '-' ? LONG_ARG : SHORT_ARG;
 }
 
-// 寻找命令
-Command *argParseFindCommand(ArgParse *argParse, const char *name) {
-    for (size_t i = 0; i < argParse->commands_len; i++) {
-        if (strcmp(argParse->commands[i]->name, name) == 0) {
-            return argParse->commands[i];
-        }
-    }
-    return NULL;
+// 写入类型并清空其余字段，长度与'='由各级别的扫描填写
+static inline void __tokenBegin(const char *arg, ArgParseToken *token) {
+    token->type   = __tokenType(arg);
+    token->eq     = -1;
+    token->hash   = 0;
+    token->hashed = false;
 }
 
-Command *argParseFindSubCommand(Command *command, const char *name) {
-    for (size_t i = 0; i < command->sub_commands_len; i++) {
-        if (strcmp(command->sub_commands[i]->name, name) == 0) {
-            return command->sub_commands[i];
+// 逐个调用C库的strlen与memchr，只有长选项查找'='
+static void __scanScalar(char *const *argv, int count, ArgParseToken *tokens) {
+    for (int i = 0; i < count; i++) {
+        ArgParseToken *token = &tokens[i];
+        __tokenBegin(argv[i], token);
+        token->len = (unsigned int)strlen(argv[i]);
+        if (token->type == LONG_ARG) {
+            const char *eq = memchr(argv[i], '=', token->len);
+            token->eq      = eq != NULL ? (int)(eq - argv[i]) : -1;
         }
     }
-    return NULL;
 }
 
-CommandArgs *createCommandArgs(const char       *short_opt,
-                               const char       *long_opt,
-                               const char       *default_val,
-                               const char       *help,
-                               ArgParseCallback  callback,
-                               bool              required,
-                               ArgParseValueType value_type) {
-    CommandArgs *args = malloc(sizeof(CommandArgs));
-
-    if (short_opt == NULL && long_opt == NULL) {
-        return NULL;
+#ifdef SCAN_X86
+/**
+ * @brief 根据一个数据块的'\0'与'='位掩码更新扫描结果
+ * @param zero '\0'位掩码
+ * @param eq '='位掩码，不需要查找'='时为0
+ * @param base 数据块相对参数起点的偏移，对齐块可能为负
+ * @param token 扫描结果
+ * @return 找到结尾返回true
+ */
+static inline bool __scanMask(uint64_t       zero,
+                              uint64_t       eq,
+                              long           base,
+                              ArgParseToken *token) {
+    if (zero != 0) {
+        unsigned int end = (unsigned int)__builtin_ctzll(zero);
+        eq &= ((uint64_t)1 << end) - 1; // 只保留结尾之前的'='
+        if (token->eq < 0 && eq != 0) {
+            token->eq = (int)(base + __builtin_ctzll(eq));
+        }
+        token->len = (unsigned int)(base + end);
+        return true;
     }
+    if (token->eq < 0 && eq != 0) {
+        token->eq = (int)(base + __builtin_ctzll(eq));
+    }
+    return false;
+}
 
-    // 分配内存
-    args->short_opt   = stringNewCopy(short_opt);
-    args->long_opt    = stringNewCopy(long_opt);
-    args->default_val = stringNewCopy(default_val);
-    args->help        = stringNewCopy(help);
-
-    args->callback    = callback;
-    args->required    = required;
-    args->value_type  = value_type;
-
-    // 解析属性初始化
-    args->val         = NULL;
-    args->val_len     = 0;
-    args->is_trigged  = false; // 是否被触发
+/*
+ * 两个级别的扫描步骤相同: 首块不跨页时先从参数起点读取，短参数一次比较即可结束；
+ * 否则从按64字节对齐的块开始逐块比较，首块中参数之前的字节以keep屏蔽。
+ * 与首次读取重叠的部分不会再找到更早的结尾或'='，重复比较不影响结果
+ */
+#define SCAN_PAGE_SAFE(arg, width)                                             \
+    (((uintptr_t)(arg) & 4095) <= 4096 - (width))
 
-    return args;
-}
+__attribute__((target("sse2"))) NO_SANITIZE_ADDRESS static void
+__scanSSE2(char *const *argv, int count, ArgParseToken *tokens) {
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i equal = _mm_set1_epi8('=');
+#define SSE2_MASK(v, c)                                                        \
+    ((uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, c)))
+    for (int i = 0; i < count; i++) {
+        const char    *arg   = argv[i];
+        ArgParseToken *token = &tokens[i];
+        __tokenBegin(arg, token);
+        bool want_eq = token->type == LONG_ARG;
 
-CommandArgs *
-argParseFindCommandArgs(Command *command, const char *name, bool short_flag) {
-    if (command == NULL) {
-        return NULL;
-    }
+        if (SCAN_PAGE_SAFE(arg, 16)) {
+            __m128i v = _mm_loadu_si128((const __m128i *)arg);
+            if (__scanMask(SSE2_MASK(v, zero),
+                           want_eq ? SSE2_MASK(v, equal) : 0,
+                           0,
+                           token)) {
+                continue;
+            }
+        }
 
-    for (size_t i = 0; i < command->args_len; i++) {
-        if (short_flag) {
-            if (command->args[i]->short_opt != NULL &&
-                strcmp(command->args[i]->short_opt, name) == 0) {
-                return command->args[i];
+        uintptr_t   skip  = (uintptr_t)arg & 63;
+        const char *block = arg - skip;
+        uint64_t    keep  = ~(uint64_t)0 << skip;
+        for (long base = -(long)skip;; block += 64, base += 64) {
+            __m128i  v0 = _mm_load_si128((const __m128i *)block);
+            __m128i  v1 = _mm_load_si128((const __m128i *)(block + 16));
+            __m128i  v2 = _mm_load_si128((const __m128i *)(block + 32));
+            __m128i  v3 = _mm_load_si128((const __m128i *)(block + 48));
+            uint64_t z  = SSE2_MASK(v0, zero) | SSE2_MASK(v1, zero) << 16 |
+                         SSE2_MASK(v2, zero) << 32 | SSE2_MASK(v3, zero) << 48;
+            uint64_t e = 0;
+            if (want_eq) {
+                e = SSE2_MASK(v0, equal) | SSE2_MASK(v1, equal) << 16 |
+                    SSE2_MASK(v2, equal) << 32 | SSE2_MASK(v3, equal) << 48;
             }
-        } else {
-            if (command->args[i]->long_opt != NULL &&
-                strcmp(command->args[i]->long_opt, name) == 0) {
-                return command->args[i];
+            if (__scanMask(z & keep, e & keep, base, token)) {
+                break;
             }
+            keep = ~(uint64_t)0;
         }
     }
-    return NULL;
+#undef SSE2_MASK
 }
 
-CommandArgs *
-argParseFindGlobalArgs(ArgParse *argParse, const char *name, bool short_flag) {
-    for (size_t i = 0; i < argParse->global_args_len; i++) {
-        if (short_flag) {
-            if (argParse->global_args[i]->short_opt != NULL &&
-                strcmp(argParse->global_args[i]->short_opt, name) == 0) {
-                return argParse->global_args[i];
+__attribute__((target("avx2"))) NO_SANITIZE_ADDRESS static void
+__scanAVX2(char *const *argv, int count, ArgParseToken *tokens) {
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i equal = _mm256_set1_epi8('=');
+#define AVX2_MASK(v, c)                                                        \
+    ((uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, c)))
+    for (int i = 0; i < count; i++) {
+        const char    *arg   = argv[i];
+        ArgParseToken *token = &tokens[i];
+        __tokenBegin(arg, token);
+        bool want_eq = token->type == LONG_ARG;
+
+        if (SCAN_PAGE_SAFE(arg, 32)) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)arg);
+            if (__scanMask(AVX2_MASK(v, zero),
+                           want_eq ? AVX2_MASK(v, equal) : 0,
+                           0,
+                           token)) {
+                continue;
+            }
+        }
+
+        uintptr_t   skip  = (uintptr_t)arg & 63;
+        const char *block = arg - skip;
+        uint64_t    keep  = ~(uint64_t)0 << skip;
+        for (long base = -(long)skip;; block += 64, base += 64) {
+            __m256i  v0 = _mm256_load_si256((const __m256i *)block);
+            __m256i  v1 = _mm256_load_si256((const __m256i *)(block + 32));
+            uint64_t z  = AVX2_MASK(v0, zero) | AVX2_MASK(v1, zero) << 32;
+            uint64_t e  = 0;
+            if (want_eq) {
+                e = AVX2_MASK(v0, equal) | AVX2_MASK(v1, equal) << 32;
             }
-        } else {
-            if (argParse->global_args[i]->long_opt != NULL &&
-                strcmp(argParse->global_args[i]->long_opt, name) == 0) {
-                return argParse->global_args[i];
+            if (__scanMask(z & keep, e & keep, base, token)) {
+                break;
             }
+            keep = ~(uint64_t)0;
         }
     }
-    return NULL;
+#undef AVX2_MASK
+}
+#endif
+
+static int _ScanLevel = -1; // 检测到的扫描级别，-1表示尚未检测
+
+static ArgParseScanLevel __detectScanLevel(void) {
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SCAN_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SCAN_SSE2;
+    }
+#endif
+    return SCAN_SCALAR;
 }
 
 /**
- * @brief 设置命令参数值
- * @param args 参数
- * @param val 值
- * @return 成功返回true，失败返回false
+ * @brief 当前CPU支持的最高扫描级别，只在第一次调用时检测
+ * 多个线程同时首次调用时可能各检测一次，结果相同，不需要加锁
+ * @return 非x86或非GCC/Clang编译时总是SCAN_SCALAR
  */
-bool argParseSetArgVal(CommandArgs *args, const char *val) {
-    if (args->value_type == ArgParseMULTIVALUE) { // 多值
-        args->val = realloc(args->val, (args->val_len + 1) * sizeof(char *));
-        if (args->val == NULL) {
-            return false;
-        }
-        args->val[args->val_len] = stringNewCopy(val);
-        if (args->val[args->val_len] == NULL) {
-            return false;
-        }
-        args->val_len++;
-        return true;
-    } else if (args->value_type == ArgParseSINGLEVALUE) { // 单值
-        if (args->val != NULL) {
-            free(args->val);
-        }
-        args->val = malloc(sizeof(char *));
-
-        if (args->val == NULL) {
-            return false;
-        }
-        args->val[0] = stringNewCopy(val); // 分配内存
-        if (args->val[0] == NULL) {
-            return false;
-        }
-        args->val_len = 1;
-        return true;
-    } else if (args->value_type == ArgParseNOVALUE) { // 无值
-        return true;
+ArgParseScanLevel argParseScanLevel() {
+    int level = argParseAtomicLoad(&_ScanLevel);
+    if (level < 0) {
+        level = __detectScanLevel();
+        argParseAtomicStore(&_ScanLevel, level);
     }
+    return (ArgParseScanLevel)level;
+}
 
-    return false;
+/**
+ * @brief 批量分类参数，写入类型、长度与长选项中'='的位置
+ * @param level 扫描级别，不得高于argParseScanLevel的返回值
+ * @param argv 参数列表
+ * @param count 参数个数
+ * @param tokens 分类结果，长度不小于count
+ */
+void argParseScanTokens(ArgParseScanLevel level,
+                        char *const      *argv,
+                        int               count,
+                        ArgParseToken    *tokens) {
+    switch (level) {
+#ifdef SCAN_X86
+    case SCAN_AVX2:
+        __scanAVX2(argv, count, tokens);
+        break;
+    case SCAN_SSE2:
+        __scanSSE2(argv, count, tokens);
+        break;
+#endif
+    default:
+        __scanScalar(argv, count, tokens);
+        break;
+    }
 }
 
-bool argParseSetCommandVal(Command *command, const char *val) {
-    if (command->value_type == ArgParseMULTIVALUE) { // 多值
-        command->val =
-            realloc(command->val, (command->val_len + 1) * sizeof(char *));
-        if (command->val == NULL) {
-            return false;
-        }
-        command->val[command->val_len] = stringNewCopy(val);
-        if (command->val[command->val_len] == NULL) {
+/**
+ * @brief 解析开始前分类全部参数，之后各处理函数只读取分类结果
+ * 分类数组保留在解析器中，重置后再次解析时参数个数不超过容量则不再分配
+ * @param argParse 解析器，argc与argv为待解析的参数
+ * @return 内存分配失败返回false
+ */
+bool argParseTokenize(ArgParse *argParse) {
+    ArgParseState *state = argParse->state;
+    int            argc  = state->argc;
+    if (argc > state->tokens_cap) {
+        ArgParseToken *tokens = argParseMemRealloc(
+            argParse,
+            state->tokens,
+            (size_t)state->tokens_cap * sizeof(ArgParseToken),
+            (size_t)argc * sizeof(ArgParseToken));
+        if (tokens == NULL) {
             return false;
         }
-        command->val_len++;
-        return true;
-    } else if (command->value_type == ArgParseSINGLEVALUE) { // 单值
-        if (command->val != NULL) {
-            free(command->val);
-        }
-        command->val = malloc(sizeof(char *));
+        state->tokens     = tokens;
+        state->tokens_cap = argc;
+    }
+    argParseScanTokens(argParseScanLevel(), state->argv, argc, state->tokens);
+    STATS_ADD(tokens, argc);
+    return true;
+}
 
-        if (command->val == NULL) {
-            return false;
-        }
-        command->val[0] = stringNewCopy(val); // 分配内存
-        if (command->val[0] == NULL) {
-            return false;
-        }
-        command->val_len = 1;
-        return true;
-    } else if (command->value_type == ArgParseNOVALUE) { // 无值
-        return true;
+/** End----------------参数分类---------------- */
+
+// 查找时使用的名字长度，--name=value只比较'='之前的部分
+static inline size_t __keyLen(const char *name, const ArgParseToken *token) {
+    if (token == NULL) {
+        return strlen(name);
     }
-    return false;
+    return token->eq >= 0 ? (size_t)token->eq : token->len;
 }
 
-/**
- * @brief 设置解析值，该值为程序所需的无命令值例如`gcc mian.c`的`main.c`
- * @param argParse 解析器
- * @param val 值
- * @return 成功返回true，失败返回false
- */
-bool argParseSetVal(ArgParse *argParse, const char *val) {
+// 节点名与长度为len的键相同，键不必以'\0'结尾
+static inline bool
+__nameEquals(const char *candidate, const char *key, size_t len) {
+    return strncmp(candidate, key, len) == 0 && candidate[len] == '\0';
+}
 
-    if (argParse->value_type == ArgParseMULTIVALUE) { // 多值
-        argParse->val =
-            realloc(argParse->val, (argParse->val_len + 1) * sizeof(char *));
-        if (argParse->val == NULL) {
-            return false;
-        }
-        argParse->val[argParse->val_len] = stringNewCopy(val);
-        if (argParse->val[argParse->val_len] == NULL) {
-            return false;
-        }
-        argParse->val_len++;
-        return true;
-    } else if (argParse->value_type == ArgParseSINGLEVALUE) { // 单值
-        if (argParse->val != NULL) {
-            free(argParse->val);
+// 静态声明的规格没有索引，按名字线性查找
+static Command *
+__scanCommands(Command **commands, int len, const char *name, size_t key_len) {
+    for (int i = 0; i < len; i++) {
+        STATS_ADD(compares, 1);
+        if (__nameEquals(commands[i]->name, name, key_len)) {
+            return commands[i];
         }
-        argParse->val = malloc(sizeof(char *));
+    }
+    return NULL;
+}
 
-        if (argParse->val == NULL) {
-            return false;
+static CommandArgs *
+__scanArgs(CommandArgs **args, int len, const char *name, size_t key_len) {
+    for (int i = 0; i < len; i++) {
+        STATS_ADD(compares, 1);
+        if (args[i]->short_opt != NULL &&
+            __nameEquals(args[i]->short_opt, name, key_len)) {
+            return args[i];
         }
-        argParse->val[0] = stringNewCopy(val); // 分配内存
-        if (argParse->val[0] == NULL) {
-            return false;
+        STATS_ADD(compares, 1);
+        if (args[i]->long_opt != NULL &&
+            __nameEquals(args[i]->long_opt, name, key_len)) {
+            return args[i];
         }
-        argParse->val_len = 1;
-        return true;
-    } else if (argParse->value_type == ArgParseNOVALUE) { // 无值
-        return true;
     }
-    return false;
+    return NULL;
 }
 
-size_t __getStrlen(const char *str) {
-    if (str == NULL) {
-        return 0;
-    }
-    return strlen(str);
+// 没有索引或索引尚无槽位时按顺序查找
+static bool __hasIndex(const ArgParseIndex *index) {
+    return index != NULL && index->entries != NULL;
 }
 
-void __catStr(char **dst, int count, ...) {
-    va_list args;
-    va_start(args, count);
-
-    size_t total_len = 0;
-    total_len        = __getStrlen(*dst);
-
-    // 计算总长度
-    char *temp       = NULL;
-    for (int i = 0; i < count; i++) {
-        temp = va_arg(args, char *);
-        total_len += __getStrlen(temp);
+// 有分类结果时直接使用其中的长度，哈希在首次查找时计算并记下
+static void *__indexFind(const ArgParseIndex *index,
+                         const char          *name,
+                         ArgParseToken       *token) {
+    if (token == NULL) {
+        return argParseIndexFind(index, name);
     }
-    va_end(args);
+    size_t key_len = __keyLen(name, token);
+    if (!token->hashed) {
+        token->hash   = __hashBytes(name, key_len);
+        token->hashed = true;
+    }
+    return argParseIndexLookup(index, name, key_len, token->hash);
+}
 
-    // 分配内存
-    *dst = realloc(*dst, total_len + 1); // +1 是为了存储字符串结束符 '\0'
-    if (*dst == NULL) {
-        va_end(args);
-        return; // 处理内存分配失败
+// 寻找命令
+Command *argParseFindCommand(ArgParse      *argParse,
+                             const char    *name,
+                             ArgParseToken *token) {
+    if (argParse == NULL || name == NULL) {
+        return NULL;
     }
+    STATS_ADD(lookups, 1);
+    if (!__hasIndex(argParse->commands_index)) {
+        return __scanCommands(argParse->commands,
+                              argParse->commands_len,
+                              name,
+                              __keyLen(name, token));
+    }
+    return __indexFind(argParse->commands_index, name, token);
+}
 
-    // 拼接字符串
-    va_start(args, count);
-    temp = NULL;
-    for (int i = 0; i < count; i++) {
-        temp = va_arg(args, char *);
-        strcat(*dst, temp);
+Command *argParseFindSubCommand(Command       *command,
+                                const char    *name,
+                                ArgParseToken *token) {
+    if (command == NULL || name == NULL) {
+        return NULL;
+    }
+    STATS_ADD(lookups, 1);
+    if (!__hasIndex(command->sub_commands_index)) {
+        return __scanCommands(command->sub_commands,
+                              command->sub_commands_len,
+                              name,
+                              __keyLen(name, token));
+    }
+    return __indexFind(command->sub_commands_index, name, token);
+}
+
+CommandArgs *createCommandArgs(ArgParse         *argParse,
+                               const char       *short_opt,
+                               const char       *long_opt,
+                               const char       *default_val,
+                               const char       *help,
+                               ArgParseCallback  callback,
+                               bool              required,
+                               ArgParseValueType value_type) {
+    if (short_opt == NULL && long_opt == NULL) {
+        return NULL;
+    }
+
+    CommandArgs *args = argParseMemAlloc(argParse, sizeof(CommandArgs));
+    if (args == NULL) {
+        return NULL;
+    }
+
+    // 分配内存
+    args->short_opt   = argParseMemStrCopy(argParse, short_opt);
+    args->long_opt    = argParseMemStrCopy(argParse, long_opt);
+    args->default_val = argParseMemStrCopy(argParse, default_val);
+    args->help        = argParseMemStrCopy(argParse, help);
+
+    args->callback       = callback;
+    args->required       = required;
+    args->value_type     = value_type;
+    args->value_callback = NULL;
+    args->value_ctx      = NULL;
+
+    return args;
+}
+
+CommandArgs *argParseFindCommandArgs(Command       *command,
+                                     const char    *name,
+                                     ArgParseToken *token) {
+    if (command == NULL || name == NULL) {
+        return NULL;
+    }
+    STATS_ADD(lookups, 1);
+    if (!__hasIndex(command->args_index)) {
+        return __scanArgs(
+            command->args, command->args_len, name, __keyLen(name, token));
+    }
+    return __indexFind(command->args_index, name, token);
+}
+
+CommandArgs *argParseFindGlobalArgs(ArgParse      *argParse,
+                                    const char    *name,
+                                    ArgParseToken *token) {
+    if (argParse == NULL || name == NULL) {
+        return NULL;
+    }
+    STATS_ADD(lookups, 1);
+    if (!__hasIndex(argParse->global_args_index)) {
+        return __scanArgs(argParse->global_args,
+                          argParse->global_args_len,
+                          name,
+                          __keyLen(name, token));
+    }
+    return __indexFind(argParse->global_args_index, name, token);
+}
+
+/**
+ * @brief 计算字符串哈希值(FNV-1a)，同时得到字符串长度
+ * @param str 字符串
+ * @param len 长度buffer
+ * @return 哈希值
+ */
+unsigned int __hashStrLen(const char *str, size_t *len) {
+    unsigned int         hash = FNV_OFFSET;
+    const unsigned char *p    = (const unsigned char *)str;
+    while (*p != '\0') {
+        hash ^= *p++;
+        hash *= FNV_PRIME;
+    }
+    *len = (size_t)(p - (const unsigned char *)str);
+    return hash;
+}
+
+// 已知长度时的哈希，与__hashStrLen的结果一致
+unsigned int __hashBytes(const char *str, size_t len) {
+    unsigned int         hash = FNV_OFFSET;
+    const unsigned char *p    = (const unsigned char *)str;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+unsigned int __hashStr(const char *str) {
+    size_t len;
+    return __hashStrLen(str, &len);
+}
+
+// 不检查重复与容量，仅供插入与扩容使用
+static void __indexPlace(ArgParseIndexEntry *entries,
+                         int                 capacity,
+                         unsigned int        hash,
+                         unsigned int        key_len,
+                         const char         *key,
+                         void               *value) {
+    unsigned int mask = (unsigned int)capacity - 1;
+    unsigned int slot = hash & mask;
+    while (entries[slot].key != NULL) {
+        slot = (slot + 1) & mask; // 线性探测
+    }
+    entries[slot].hash    = hash;
+    entries[slot].key_len = key_len;
+    entries[slot].key     = key;
+    entries[slot].value   = value;
+}
+
+/**
+ * @brief 向索引插入键值，键已存在时保留先注册的节点
+ * @param argParse 索引所属解析器
+ * @param slot 节点中的索引指针，为NULL时先创建索引
+ * @param key 键，其内存需与索引生命周期一致
+ * @param value 值
+ * @return 成功返回true，内存分配失败返回false
+ */
+bool argParseIndexInsert(ArgParse       *argParse,
+                         ArgParseIndex **slot,
+                         const char     *key,
+                         void           *value) {
+    if (slot == NULL || key == NULL) {
+        return false;
+    }
+    if (*slot == NULL) {
+        *slot = argParseMemAlloc(argParse, sizeof(ArgParseIndex));
+        if (*slot == NULL) {
+            return false;
+        }
+        **slot = (ArgParseIndex){NULL, 0, 0, NULL};
+    }
+    ArgParseIndex *index = *slot;
+    if (argParseIndexFind(index, key) != NULL) {
+        return true;
+    }
+
+    // 负载因子保持在1/2以下，命中时平均探测次数接近1
+    if ((index->len + 1) * 2 > index->capacity) {
+        int    capacity = index->capacity == 0 ? 8 : index->capacity * 2;
+        size_t size     = (size_t)capacity * sizeof(ArgParseIndexEntry);
+        ArgParseIndexEntry *entries = argParseMemAlloc(argParse, size);
+        if (entries == NULL) {
+            return false;
+        }
+        memset(entries, 0, size);
+        for (int i = 0; i < index->capacity; i++) {
+            if (index->entries[i].key != NULL) {
+                __indexPlace(entries,
+                             capacity,
+                             index->entries[i].hash,
+                             index->entries[i].key_len,
+                             index->entries[i].key,
+                             index->entries[i].value);
+            }
+        }
+        argParseMemFree(argParse, index->entries);
+        index->entries  = entries;
+        index->capacity = capacity;
+    }
+
+    size_t       key_len;
+    unsigned int hash = __hashStrLen(key, &key_len);
+    __indexPlace(index->entries,
+                 index->capacity,
+                 hash,
+                 (unsigned int)key_len,
+                 key,
+                 value);
+    index->len++;
+    return true;
+}
+
+/**
+ * @brief 在索引中查找键
+ * @param index 索引
+ * @param key 键
+ * @return 找到返回值，否则返回NULL
+ */
+void *argParseIndexFind(const ArgParseIndex *index, const char *key) {
+    if (index == NULL || index->capacity == 0) {
+        return NULL;
+    }
+    size_t       key_len;
+    unsigned int hash = __hashStrLen(key, &key_len);
+    return argParseIndexLookup(index, key, key_len, hash);
+}
+
+/**
+ * @brief 完美哈希索引中键所在的桶，每4个槽位对应一个桶
+ * 桶取哈希的高位，槽位由混合后的低位决定，两者相互独立
+ * @param hash 键哈希值
+ * @param capacity 槽位数
+ * @return 桶序号
+ */
+unsigned int argParsePerfectBucket(unsigned int hash, int capacity) {
+    return (hash >> 16) & (((unsigned int)capacity >> 2) - 1);
+}
+
+/**
+ * @brief 以桶位移扰动哈希后得到完美哈希中键的槽位
+ * 生成器为每个桶挑选位移，使全部键落在互不相同的槽位上
+ * @param hash 键哈希值
+ * @param capacity 槽位数
+ * @param displace 键所在桶的位移
+ * @return 槽位序号
+ */
+unsigned int
+argParsePerfectSlot(unsigned int hash, int capacity, unsigned short displace) {
+    unsigned int x  = hash + displace * 0x9E3779B9u;
+    x              ^= x >> 16;
+    x              *= 0x85EBCA6Bu;
+    x              ^= x >> 13;
+    return x & ((unsigned int)capacity - 1);
+}
+
+/**
+ * @brief 以已知的长度与哈希查找键，key无需以'\0'结尾
+ * @param index 索引
+ * @param key 键
+ * @param key_len 键长度
+ * @param hash 键哈希值，需与__hashStrLen一致
+ * @return 找到返回值，否则返回NULL
+ */
+void *argParseIndexLookup(const ArgParseIndex *index,
+                          const char          *key,
+                          size_t               key_len,
+                          unsigned int         hash) {
+    if (index == NULL || index->capacity == 0) {
+        return NULL;
+    }
+    if (index->displace != NULL) {
+        // 生成代码中的完美哈希索引，每个键只有唯一的候选槽位
+        unsigned int bucket = argParsePerfectBucket(hash, index->capacity);
+        const ArgParseIndexEntry *entry =
+            &index->entries[argParsePerfectSlot(
+                hash, index->capacity, index->displace[bucket])];
+        if (entry->key == NULL || entry->hash != hash ||
+            entry->key_len != key_len) {
+            return NULL;
+        }
+        STATS_ADD(compares, 1);
+        return memcmp(entry->key, key, key_len) == 0 ? entry->value : NULL;
+    }
+    unsigned int mask = (unsigned int)index->capacity - 1;
+    unsigned int slot = hash & mask;
+    while (index->entries[slot].key != NULL) {
+        const ArgParseIndexEntry *entry = &index->entries[slot];
+        if (entry->hash == hash && entry->key_len == key_len) {
+            STATS_ADD(compares, 1);
+            if (memcmp(entry->key, key, key_len) == 0) {
+                return entry->value;
+            }
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+void argParseIndexFree(ArgParse *argParse, ArgParseIndex **index) {
+    if (index == NULL || *index == NULL) {
+        return;
+    }
+    argParseMemFree(argParse, (*index)->entries);
+    argParseMemFree(argParse, *index);
+    *index = NULL;
+}
+
+/** Start----------------解析结果---------------- */
+
+// 节点地址低位因对齐恒为0，先移除再混合，使槽位分布均匀
+static unsigned int __hashPtr(const void *ptr) {
+    uintptr_t    value = (uintptr_t)ptr;
+    unsigned int hash  = (unsigned int)(value >> 4) ^
+                        (unsigned int)((uint64_t)value >> 36);
+    hash *= 2654435761u;
+    return hash ^ (hash >> 15);
+}
+
+/**
+ * @brief 查找节点的解析结果
+ * @param slots 结果表
+ * @param node 节点
+ * @return 节点未被解析到时返回NULL
+ */
+ArgParseSlot *argParseSlotFind(const ArgParseSlots *slots, const void *node) {
+    if (slots == NULL || node == NULL || slots->capacity == 0) {
+        return NULL;
+    }
+    unsigned int mask = (unsigned int)slots->capacity - 1;
+    unsigned int slot = __hashPtr(node) & mask;
+    while (slots->entries[slot].node != NULL) {
+        if (slots->entries[slot].node == node) {
+            return &slots->entries[slot];
+        }
+        slot = (slot + 1) & mask; // 线性探测
+    }
+    return NULL;
+}
+
+// 不检查重复与容量，仅供插入与扩容使用
+static ArgParseSlot *
+__slotPlace(ArgParseSlot *entries, int capacity, const void *node) {
+    unsigned int mask = (unsigned int)capacity - 1;
+    unsigned int slot = __hashPtr(node) & mask;
+    while (entries[slot].node != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    entries[slot].node = node;
+    return &entries[slot];
+}
+
+/**
+ * @brief 获取节点的解析结果，不存在时创建
+ * 返回的指针在下一次插入新节点前有效
+ * @param argParse 解析器
+ * @param node 节点
+ * @return 结果槽位，内存分配失败返回NULL
+ */
+ArgParseSlot *argParseSlotGet(ArgParse *argParse, const void *node) {
+    ArgParseSlots *slots = &argParse->state->results;
+    ArgParseSlot  *found = argParseSlotFind(slots, node);
+    if (found != NULL) {
+        return found;
+    }
+
+    // 负载因子保持在1/2以下
+    if ((slots->len + 1) * 2 > slots->capacity) {
+        int    capacity = slots->capacity == 0 ? 16 : slots->capacity * 2;
+        size_t size     = (size_t)capacity * sizeof(ArgParseSlot);
+        ArgParseSlot *entries = argParseMemAlloc(argParse, size);
+        if (entries == NULL) {
+            return NULL;
+        }
+        memset(entries, 0, size);
+        for (int i = 0; i < slots->capacity; i++) {
+            if (slots->entries[i].node != NULL) {
+                *__slotPlace(entries, capacity, slots->entries[i].node) =
+                    slots->entries[i];
+            }
+        }
+        argParseMemFree(argParse, slots->entries);
+        slots->entries  = entries;
+        slots->capacity = capacity;
+    }
+
+    slots->len++;
+    return __slotPlace(slots->entries, slots->capacity, node);
+}
+
+/**
+ * @brief 标记节点被触发
+ * @param argParse 解析器
+ * @param node 节点
+ * @return 成功返回true，内存分配失败返回false
+ */
+bool argParseMarkTriggered(ArgParse *argParse, const void *node) {
+    ArgParseSlot *slot = argParseSlotGet(argParse, node);
+    if (slot == NULL) {
+        return false;
+    }
+    slot->is_trigged = true;
+    return true;
+}
+
+// 节点是否在本次解析中被触发
+bool argParseIsTriggered(ArgParse *argParse, const void *node) {
+    if (argParse->state == NULL) {
+        return false; // 尚未解析过的静态规格
+    }
+    ArgParseSlot *slot = argParseSlotFind(&argParse->state->results, node);
+    return slot != NULL && slot->is_trigged;
+}
+
+/** End----------------解析结果---------------- */
+
+/**
+ * @brief 保存一个解析到的值，借用模式下直接指向argv
+ * @param argParse 解析器
+ * @param val 值
+ * @return 值指针
+ */
+char *argParseValueCopy(ArgParse *argParse, const char *val) {
+    if (argParse->borrow_values) {
+        return (char *)val;
+    }
+    return argParseMemStrCopy(argParse, val);
+}
+
+/**
+ * @brief 向值数组写入一段值
+ * 多值时容量不足则一次扩到能容纳整段，且至少翻倍，避免逐个realloc；
+ * 单值时复用已有的单元素数组，只保留最后一个值
+ * @param argParse 解析器
+ * @param value_type 值类型
+ * @param val 值数组
+ * @param val_len 值个数
+ * @param val_cap 值数组容量
+ * @param vals 待写入的值
+ * @param count 待写入的值个数
+ * @return 成功返回true，失败返回false
+ */
+static bool __setValues(ArgParse         *argParse,
+                        ArgParseValueType value_type,
+                        char           ***val,
+                        int              *val_len,
+                        int              *val_cap,
+                        char *const      *vals,
+                        int               count) {
+    if (value_type == ArgParseNOVALUE) { // 无值
+        return true;
+    }
+    if (count <= 0) {
+        return true;
+    }
+
+    if (value_type == ArgParseSINGLEVALUE) { // 单值
+        if (*val == NULL) {
+            *val = argParseMemAlloc(argParse, sizeof(char *));
+            if (*val == NULL) {
+                return false;
+            }
+            *val_cap = 1;
+        } else if (*val_len > 0 && !argParse->borrow_values) {
+            argParseMemFree(argParse, (*val)[0]);
+        }
+        *val_len  = 0;
+        (*val)[0] = argParseValueCopy(argParse, vals[count - 1]);
+        if ((*val)[0] == NULL) {
+            return false;
+        }
+        *val_len = 1;
+        return true;
+    }
+
+    if (value_type == ArgParseMULTIVALUE) { // 多值
+        if (*val_len + count > *val_cap) {
+            int capacity = *val_cap * 2;
+            if (capacity < *val_len + count) {
+                capacity = *val_len + count;
+            }
+            size_t old_size = (size_t)*val_cap * sizeof(char *);
+            char **grown    = argParseMemRealloc(
+                argParse, *val, old_size, (size_t)capacity * sizeof(char *));
+            if (grown == NULL) {
+                return false;
+            }
+            *val     = grown;
+            *val_cap = capacity;
+        }
+        for (int i = 0; i < count; i++) {
+            (*val)[*val_len] = argParseValueCopy(argParse, vals[i]);
+            if ((*val)[*val_len] == NULL) {
+                return false;
+            }
+            (*val_len)++;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief 设置命令参数值
+ * @param argParse 解析器
+ * @param args 参数
+ * @param val 值
+ * @return 成功返回true，失败返回false
+ */
+bool argParseSetArgVal(ArgParse    *argParse,
+                       CommandArgs *args,
+                       const char  *val) {
+    return argParseSetArgVals(argParse, args, (char *const *)&val, 1);
+}
+
+/**
+ * @brief 一次设置一段命令参数值，数组按整段长度预留
+ * @param argParse 解析器
+ * @param args 参数
+ * @param vals 值
+ * @param count 值个数
+ * @return 成功返回true，失败返回false
+ */
+bool argParseSetArgVals(ArgParse    *argParse,
+                        CommandArgs *args,
+                        char *const *vals,
+                        int          count) {
+    ArgParseSlot *slot = argParseSlotGet(argParse, args);
+    if (slot == NULL) {
+        return false;
+    }
+    return __setValues(argParse,
+                       args->value_type,
+                       &slot->val,
+                       &slot->val_len,
+                       &slot->val_cap,
+                       vals,
+                       count);
+}
+
+bool argParseSetCommandVal(ArgParse   *argParse,
+                           Command    *command,
+                           const char *val) {
+    return argParseSetCommandVals(argParse, command, (char *const *)&val, 1);
+}
+
+bool argParseSetCommandVals(ArgParse    *argParse,
+                            Command     *command,
+                            char *const *vals,
+                            int          count) {
+    ArgParseSlot *slot = argParseSlotGet(argParse, command);
+    if (slot == NULL) {
+        return false;
+    }
+    return __setValues(argParse,
+                       command->value_type,
+                       &slot->val,
+                       &slot->val_len,
+                       &slot->val_cap,
+                       vals,
+                       count);
+}
+
+/**
+ * @brief 设置解析值，该值为程序所需的无命令值例如`gcc mian.c`的`main.c`
+ * @param argParse 解析器
+ * @param val 值
+ * @return 成功返回true，失败返回false
+ */
+bool argParseSetVal(ArgParse *argParse, const char *val) {
+    return argParseSetVals(argParse, (char *const *)&val, 1);
+}
+
+bool argParseSetVals(ArgParse *argParse, char *const *vals, int count) {
+    return __setValues(argParse,
+                       argParse->value_type,
+                       &argParse->state->val,
+                       &argParse->state->val_len,
+                       &argParse->state->val_cap,
+                       vals,
+                       count);
+}
+
+/**
+ * @brief 统计从start开始连续的值(非选项)个数
+ * @param tokens 参数分类结果
+ * @param argc 参数个数
+ * @param start 起始索引
+ * @return 值个数
+ */
+int argParseCountValues(const ArgParseToken *tokens, int argc, int start) {
+    int end = start;
+    while (end < argc && tokens[end].type == COMMAND) {
+        end++;
+    }
+    return end - start;
+}
+
+/** Start----------------@file参数展开---------------- */
+
+#define RESPONSE_FILE_DEPTH 10 // @file嵌套展开的最大层数，超过后按普通参数处理
+
+#ifdef _WIN32
+// 没有mmap时整体读入堆内存，之后的原地切分逻辑相同
+bool argParseMapFile(const char *path, ArgParseMapping *mapping) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *data = size < 0 ? NULL : argParseHeapAlloc((size_t)size + 1);
+    if (data == NULL) {
+        fclose(file);
+        return false;
+    }
+    size_t read = fread(data, 1, (size_t)size, file);
+    fclose(file);
+    data[read]    = '\0';
+    mapping->addr = data;
+    mapping->size = read;
+    return true;
+}
+
+void argParseUnmapFile(ArgParseMapping *mapping) {
+    argParseHeapFree(mapping->addr);
+}
+#else
+// 映射的内容随后都会被读完并原地改写，一次性预先建立页面，免去逐页缺页与写时复制
+#ifdef MAP_POPULATE
+#define MAP_FILE_POPULATE MAP_POPULATE
+#else
+#define MAP_FILE_POPULATE 0
+#endif
+
+/**
+ * @brief 以私有可写方式映射文件，切分时写入的'\0'不会影响文件本身
+ * 映射比文件多一个字节，保证最后一个参数也有位置写结尾；
+ * 文件长度恰为页大小整数倍时，这个字节落在预留的匿名页中
+ * @param path 文件路径
+ * @param mapping 映射buffer
+ * @return 成功返回true
+ */
+bool argParseMapFile(const char *path, ArgParseMapping *mapping) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    char  *addr = mmap(NULL,
+                      size + 1,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS,
+                      -1,
+                      0);
+    if (addr == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    if (size > 0 && mmap(addr,
+                         size,
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_FIXED | MAP_FILE_POPULATE,
+                         fd,
+                         0) == MAP_FAILED) {
+        munmap(addr, size + 1);
+        close(fd);
+        return false;
+    }
+    close(fd);
+    mapping->addr = addr;
+    mapping->size = size;
+    return true;
+}
+
+void argParseUnmapFile(ArgParseMapping *mapping) {
+    munmap(mapping->addr, mapping->size + 1);
+}
+#endif
+
+static bool __isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' ||
+           c == '\v';
+}
+
+/**
+ * @brief 在映射内原地切出下一个参数
+ * 引号内的空白属于参数，反斜杠转义下一个字符(单引号内除外)；
+ * 去掉引号与转义后参数只会变短，因此直接在原位置前移并写入'\0'
+ * @param cursor 当前位置，返回时移到参数之后
+ * @param end 映射内容结尾，其后至少还有一个可写字节
+ * @return 参数，没有更多参数时返回NULL
+ */
+static char *__nextToken(char **cursor, char *end) {
+    char *p = *cursor;
+    while (p < end && __isSpace(*p)) {
+        p++;
+    }
+    if (p >= end) {
+        *cursor = end;
+        return NULL;
+    }
+
+    char *token = p;
+    char *out   = p;
+    char  quote = '\0';
+    while (p < end) {
+        char c = *p;
+        if (quote != '\0' && c == quote) {
+            quote = '\0';
+            p++;
+            continue;
+        }
+        if (quote == '\0' && (c == '"' || c == '\'')) {
+            quote = c;
+            p++;
+            continue;
+        }
+        if (quote == '\0' && __isSpace(c)) {
+            break;
+        }
+        if (c == '\\' && quote != '\'' && p + 1 < end) {
+            c = *++p;
+        }
+        if (out != p) {
+            *out = c; // 只有去掉过引号或转义时才需要前移
+        }
+        out++;
+        p++;
+    }
+    *out    = '\0';
+    *cursor = p < end ? p + 1 : end;
+    return token;
+}
+
+typedef struct ArgList {
+    char **items; // 参数
+    int    len;   // 参数个数
+    int    cap;   // 容量
+} ArgList;
+
+static bool __pushArg(ArgParse *argParse, ArgList *list, char *arg) {
+    if (list->len == list->cap) {
+        int    cap   = list->cap < 16 ? 16 : list->cap * 2;
+        char **items = argParseMemRealloc(argParse,
+                                          list->items,
+                                          (size_t)list->cap * sizeof(char *),
+                                          (size_t)cap * sizeof(char *));
+        if (items == NULL) {
+            return false;
+        }
+        list->items = items;
+        list->cap   = cap;
+    }
+    list->items[list->len++] = arg;
+    return true;
+}
+
+// 展开单个参数，@path递归展开为文件中的参数，其余参数原样保留
+static bool __expandArg(ArgParse    *argParse,
+                        ArgList     *list,
+                        char        *arg,
+                        int          depth,
+                        const char **failed) {
+    if (arg[0] != '@' || arg[1] == '\0' || depth >= RESPONSE_FILE_DEPTH) {
+        return __pushArg(argParse, list, arg);
+    }
+
+    ArgParseState   *state    = argParse->state;
+    ArgParseMapping  mapping;
+    ArgParseMapping *mappings = NULL;
+    if (argParseMapFile(arg + 1, &mapping)) {
+        mappings = argParseMemGrow(argParse,
+                                   state->mappings,
+                                   state->mappings_len,
+                                   sizeof(ArgParseMapping));
+        if (mappings == NULL) {
+            argParseUnmapFile(&mapping);
+        }
+    }
+    if (mappings == NULL) {
+        *failed = arg;
+        return false;
+    }
+    state->mappings                        = mappings;
+    state->mappings[state->mappings_len++] = mapping;
+
+    char *cursor = mapping.addr;
+    char *end    = cursor + mapping.size;
+    char *token  = NULL;
+    while ((token = __nextToken(&cursor, end)) != NULL) {
+        if (!__expandArg(argParse, list, token, depth + 1, failed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 展开参数列表中的@file参数，argv[0]保持不变
+ * 展开后的列表与文件映射保存在解析器中，由argParseReleaseResponseFiles释放；
+ * 不经重置再次解析时释放上一次的列表，映射可能仍被借用的值引用，继续保留
+ * @param argParse 解析器
+ * @param argc 参数个数
+ * @param argv 参数列表
+ * @param failed 文件无法读取时返回对应的参数
+ * @param failed_index 文件无法读取时返回展开前所在的argv位置
+ * @return 成功返回true，没有@file参数时不做任何事
+ */
+bool argParseExpandResponseFiles(ArgParse    *argParse,
+                                 int          argc,
+                                 char        *argv[],
+                                 const char **failed,
+                                 int         *failed_index) {
+    int first = 1;
+    while (first < argc && argv[first][0] != '@') {
+        first++;
+    }
+    if (first >= argc) {
+        return true;
+    }
+
+    ArgList list = {NULL, 0, 0};
+    for (int i = 0; i < argc; i++) {
+        bool ok = i < first ? __pushArg(argParse, &list, argv[i])
+                            : __expandArg(argParse, &list, argv[i], 0, failed);
+        if (!ok) {
+            argParseMemFree(argParse, list.items);
+            *failed_index = i;
+            return false;
+        }
+    }
+
+    argParseMemFree(argParse, argParse->state->expanded_argv);
+    argParse->state->expanded_argv = list.items;
+    argParse->state->argc          = list.len;
+    argParse->state->argv          = list.items;
+    return true;
+}
+
+// 释放@file展开时建立的映射与参数列表
+void argParseReleaseResponseFiles(ArgParse *argParse) {
+    ArgParseState *state = argParse->state;
+    for (int i = 0; i < state->mappings_len; i++) {
+        argParseUnmapFile(&state->mappings[i]);
+    }
+    argParseMemFree(argParse, state->mappings);
+    argParseMemFree(argParse, state->expanded_argv);
+    state->mappings      = NULL;
+    state->mappings_len  = 0;
+    state->expanded_argv = NULL;
+}
+
+/** End----------------@file参数展开---------------- */
+
+size_t __getStrlen(const char *str) {
+    if (str == NULL) {
+        return 0;
+    }
+    return strlen(str);
+}
+
+/** Start----------------字符串构造---------------- */
+
+void strBuilderInit(StrBuilder *builder) {
+    builder->data = NULL;
+    builder->len  = 0;
+    builder->cap  = 0;
+}
+
+/**
+ * @brief 追加指定长度的字符串，容量不足时按倍数扩容
+ * @param builder 构造器
+ * @param str 字符串
+ * @param len 长度
+ * @return 成功返回true，内存分配失败返回false
+ */
+bool strBuilderAppendN(StrBuilder *builder, const char *str, size_t len) {
+    if (builder->len + len + 1 > builder->cap) {
+        size_t cap = builder->cap == 0 ? 256 : builder->cap * 2;
+        while (cap < builder->len + len + 1) {
+            cap *= 2;
+        }
+        char *data = argParseHeapRealloc(builder->data, cap);
+        if (data == NULL) {
+            return false;
+        }
+        builder->data = data;
+        builder->cap  = cap;
+    }
+    memcpy(builder->data + builder->len, str, len);
+    builder->len += len;
+    builder->data[builder->len] = '\0';
+    return true;
+}
+
+/**
+ * @brief 依次追加count个字符串，NULL视为空串
+ * @param builder 构造器
+ * @param count 字符串个数
+ * @return 成功返回true，内存分配失败返回false
+ */
+bool strBuilderAppend(StrBuilder *builder, int count, ...) {
+    va_list args;
+    va_start(args, count);
+
+    bool ok = true;
+    for (int i = 0; i < count && ok; i++) {
+        const char *str = va_arg(args, const char *);
+        ok              = strBuilderAppendN(builder, str, __getStrlen(str));
+    }
+
+    va_end(args);
+    return ok;
+}
+
+/**
+ * @brief 取出构造好的字符串，所有权转移给调用方
+ * @param builder 构造器
+ * @return 字符串，需调用方free
+ */
+char *strBuilderDetach(StrBuilder *builder) {
+    if (builder->data == NULL) {
+        strBuilderAppendN(builder, "", 0);
+    }
+    char *data = builder->data;
+    strBuilderInit(builder);
+    return data;
+}
+
+void strBuilderFree(StrBuilder *builder) {
+    argParseHeapFree(builder->data);
+    strBuilderInit(builder);
+}
+
+/** End----------------字符串构造---------------- */
+
+/** Start----------------原子操作---------------- */
+
+#ifdef _MSC_VER
+int argParseAtomicLoad(const int *value) {
+    return InterlockedCompareExchange((volatile LONG *)value, 0, 0);
+}
+
+void argParseAtomicStore(int *value, int desired) {
+    InterlockedExchange((volatile LONG *)value, desired);
+}
+
+void argParseSpinLock(int *lock) {
+    while (InterlockedExchange((volatile LONG *)lock, 1) != 0) {
+        SwitchToThread();
+    }
+}
+
+void argParseSpinUnlock(int *lock) {
+    InterlockedExchange((volatile LONG *)lock, 0);
+}
+
+int argParseAtomicAdd(int *value, int delta) {
+    return InterlockedExchangeAdd((volatile LONG *)value, delta);
+}
+#else
+int argParseAtomicLoad(const int *value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+void argParseAtomicStore(int *value, int desired) {
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 获取自旋锁，只用于延迟构造命令等很少发生且很短的临界区
+ * 锁被占用时只读地等待并让出CPU，避免反复写同一缓存行
+ * @param lock 锁，0表示空闲
+ */
+void argParseSpinLock(int *lock) {
+    while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE) != 0) {
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED) != 0) {
+#ifdef _WIN32
+            SwitchToThread();
+#else
+            sched_yield();
+#endif
+        }
+    }
+}
+
+void argParseSpinUnlock(int *lock) {
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+int argParseAtomicAdd(int *value, int delta) {
+    return __atomic_fetch_add(value, delta, __ATOMIC_ACQ_REL);
+}
+#endif
+
+/** End----------------原子操作---------------- */
+
+/** Start----------------工作线程---------------- */
+
+typedef struct WorkerTask {
+    void (*run)(void *ctx); // 线程函数
+    void *ctx;              // 线程函数的参数，各线程共用
+} WorkerTask;
+
+int argParseCpuCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI __workerMain(LPVOID param) {
+    WorkerTask *task = param;
+    task->run(task->ctx);
+    return 0;
+}
+#elif defined(ARGPARSE_THREADS)
+static void *__workerMain(void *param) {
+    WorkerTask *task = param;
+    task->run(task->ctx);
+    return NULL;
+}
+#endif
+
+/**
+ * @brief 在threads个线程中同时执行run(ctx)，调用线程本身也执行一份
+ * 未启用线程支持(ARGPARSE_THREADS)时只在调用线程中执行一次；
+ * 创建线程失败时不再继续创建，已启动的线程照常完成
+ * @param threads 期望的线程数，含调用线程
+ * @param run 线程函数，需自行从ctx中领取工作
+ * @param ctx 线程函数的参数
+ * @return 实际执行run的线程数
+ */
+int argParseRunWorkers(int threads, void (*run)(void *ctx), void *ctx) {
+    WorkerTask task    = {run, ctx};
+    int        started = 0;
+#if defined(_WIN32)
+    HANDLE *handles =
+        threads > 1 ? argParseHeapAlloc((threads - 1) * sizeof(HANDLE)) : NULL;
+    while (handles != NULL && started < threads - 1) {
+        handles[started] = CreateThread(NULL, 0, __workerMain, &task, 0, NULL);
+        if (handles[started] == NULL) {
+            break;
+        }
+        started++;
+    }
+#elif defined(ARGPARSE_THREADS)
+    pthread_t *handles =
+        threads > 1 ? argParseHeapAlloc((threads - 1) * sizeof(pthread_t))
+                    : NULL;
+    while (handles != NULL && started < threads - 1) {
+        if (pthread_create(&handles[started], NULL, __workerMain, &task) != 0) {
+            break;
+        }
+        started++;
+    }
+#else
+    (void)threads;
+#endif
+
+    run(ctx);
+
+#if defined(_WIN32)
+    for (int i = 0; i < started; i++) {
+        WaitForSingleObject(handles[i], INFINITE);
+        CloseHandle(handles[i]);
+    }
+    argParseHeapFree(handles);
+#elif defined(ARGPARSE_THREADS)
+    for (int i = 0; i < started; i++) {
+        pthread_join(handles[i], NULL);
+    }
+    argParseHeapFree(handles);
+#endif
+    return started + 1;
+}
+
+/** End----------------工作线程---------------- */
+
+/** Start----------------文本输出---------------- */
+
+void textSinkInitBuilder(TextSink *sink, StrBuilder *builder) {
+    sink->builder   = builder;
+    sink->fd        = -1;
+    sink->spans_len = 0;
+    sink->ok        = true;
+}
+
+void textSinkInitFd(TextSink *sink, int fd) {
+    sink->builder   = NULL;
+    sink->fd        = fd;
+    sink->spans_len = 0;
+    sink->ok        = true;
+}
+
+/**
+ * @brief 输出到file底层的文件描述符
+ * 先刷新file中已缓冲的内容，保证与之前经由file输出的内容顺序一致
+ * @param sink 输出目标
+ * @param file 文件
+ */
+void textSinkInitFile(TextSink *sink, FILE *file) {
+    fflush(file);
+#ifdef _WIN32
+    textSinkInitFd(sink, _fileno(file));
+#else
+    textSinkInitFd(sink, fileno(file));
+#endif
+}
+
+#ifdef _WIN32
+// 没有writev时逐个片段写出
+static bool __writeSpans(int fd, TextSpan *spans, int count) {
+    for (int i = 0; i < count; i++) {
+        const char *data = spans[i].data;
+        size_t      left = spans[i].len;
+        while (left > 0) {
+            int n = _write(fd, data, (unsigned int)left);
+            if (n < 0) {
+                return false;
+            }
+            data += n;
+            left -= (size_t)n;
+        }
+    }
+    return true;
+}
+#else
+/**
+ * @brief 以writev写出全部片段，处理部分写入与信号中断
+ * @param fd 文件描述符
+ * @param spans 片段
+ * @param count 片段数
+ * @return 全部写出返回true
+ */
+static bool __writeSpans(int fd, TextSpan *spans, int count) {
+    struct iovec iov[TEXT_SINK_SPANS];
+    for (int i = 0; i < count; i++) {
+        iov[i].iov_base = (void *)spans[i].data;
+        iov[i].iov_len  = spans[i].len;
+    }
+
+    struct iovec *cursor = iov;
+    while (count > 0) {
+        ssize_t n = writev(fd, cursor, count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        // 跳过已写完的片段，最后一个未写完的片段从中间继续
+        while (count > 0 && (size_t)n >= cursor->iov_len) {
+            n -= (ssize_t)cursor->iov_len;
+            cursor++;
+            count--;
+        }
+        if (count > 0) {
+            cursor->iov_base = (char *)cursor->iov_base + n;
+            cursor->iov_len -= (size_t)n;
+        }
+    }
+    return true;
+}
+#endif
+
+/**
+ * @brief 写出聚集的片段，输出到构造器时不做任何事
+ * @param sink 输出目标
+ * @return 之前的追加与写入全部成功返回true
+ */
+bool textSinkFlush(TextSink *sink) {
+    if (sink->builder == NULL && sink->spans_len > 0) {
+        if (!__writeSpans(sink->fd, sink->spans, sink->spans_len)) {
+            sink->ok = false;
+        }
+        sink->spans_len = 0;
+    }
+    return sink->ok;
+}
+
+/**
+ * @brief 依次追加count个字符串，NULL与空串不产生片段
+ * 输出到文件描述符时只记录片段位置，聚集满TEXT_SINK_SPANS个后写出一次，
+ * 因此字符串在下一次textSinkFlush之前必须保持有效
+ * @param sink 输出目标
+ * @param count 字符串个数
+ * @return 之前的追加与写入全部成功返回true
+ */
+bool textSinkAppend(TextSink *sink, int count, ...) {
+    va_list args;
+    va_start(args, count);
+
+    for (int i = 0; i < count && sink->ok; i++) {
+        const char *str = va_arg(args, const char *);
+        size_t      len = __getStrlen(str);
+        if (sink->builder != NULL) {
+            sink->ok = strBuilderAppendN(sink->builder, str, len);
+            continue;
+        }
+        if (len == 0) {
+            continue;
+        }
+        if (sink->spans_len == TEXT_SINK_SPANS) {
+            textSinkFlush(sink);
+        }
+        sink->spans[sink->spans_len++] = (TextSpan){str, len};
     }
 
     va_end(args);
-}
\ No newline at end of file
+    return sink->ok;
+}
+
+/** End----------------文本输出---------------- */
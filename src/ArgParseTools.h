@@ -4,11 +4,69 @@
 #include "ArgParse.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+#ifdef ARGPARSE_STATS
+// 当前线程正在统计的解析器，以及分配计入的字段
+extern THREAD_LOCAL ArgParseStats *argParseActiveStats;
+extern THREAD_LOCAL size_t        *argParseActiveAllocs;
+
+double argParseNowNs(); // 单调时钟，纳秒
+
+#define STATS_ADD(field, n)                                                    \
+    do {                                                                       \
+        if (argParseActiveStats != NULL) {                                     \
+            argParseActiveStats->field += (n);                                 \
+        }                                                                      \
+    } while (0)
+#define STATS_ALLOC()                                                          \
+    do {                                                                       \
+        if (argParseActiveAllocs != NULL) {                                    \
+            (*argParseActiveAllocs)++;                                         \
+        }                                                                      \
+    } while (0)
+
+// 记录阶段起点
+#define STATS_CLOCK(start) double start = argParseNowNs()
+// 把从start到现在的耗时累加到field，并以现在作为下一阶段的起点
+#define STATS_PHASE(argParse, field, start)                                    \
+    do {                                                                       \
+        double now_                    = argParseNowNs();                      \
+        (argParse)->state->stats.field += now_ - (start);                      \
+        (start)                         = now_;                                \
+    } while (0)
+
+typedef struct ArgParseStatsScope {
+    ArgParseStats *target; // 计入耗时的统计，嵌套调用时为NULL
+    size_t        *allocs; // 进入前分配计入的字段
+    double         start;  // 开始时间
+} ArgParseStatsScope;
+
+ArgParseStatsScope argParseSpecBegin(ArgParse *argParse); // 进入构造API
+void argParseSpecEnd(ArgParseStatsScope scope);           // 离开构造API
+
+#define SPEC_BEGIN(argParse)                                                   \
+    ArgParseStatsScope spec_scope_ = argParseSpecBegin(argParse)
+#define SPEC_END() argParseSpecEnd(spec_scope_)
+#else
+#define STATS_ADD(field, n)                 ((void)0)
+#define STATS_ALLOC()                       ((void)0)
+#define STATS_CLOCK(start)                  ((void)0)
+#define STATS_PHASE(argParse, field, start) ((void)0)
+#define SPEC_BEGIN(argParse)                ((void)0)
+#define SPEC_END()                          ((void)0)
+#endif
+
 typedef enum {
     LONG_ARG,  // 长选项
     SHORT_ARG, // 短选项
@@ -16,7 +74,91 @@ typedef enum {
     BAD,       // 错误
 } ArgType;
 
-Command *createCommand(const char       *name,
+typedef struct ArgParseToken {
+    unsigned int  len;    // 参数长度
+    int           eq;     // 长选项中第一个'='的偏移，没有时为-1
+    unsigned int  hash;   // 与索引相同的哈希值，首次用作查找键时计算
+    unsigned char type;   // 参数类型，ArgType
+    bool          hashed; // hash是否已计算
+} ArgParseToken;          // 预先分类的参数，与argv一一对应，16字节
+
+typedef struct ArgParseIndexEntry {
+    unsigned int hash;    // 键哈希值
+    unsigned int key_len; // 键长度，比较前先比哈希与长度
+    const char  *key;     // 键，指向节点自身持有的名字
+    void        *value;   // 值，CommandArgs* 或 Command*
+} ArgParseIndexEntry;
+
+typedef struct ArgParseIndex {
+    ArgParseIndexEntry   *entries;  // 开放寻址槽位
+    int                   capacity; // 槽位数，始终为2的幂
+    int                   len;      // 已占用槽位数
+    const unsigned short *displace; // 生成代码的完美哈希桶位移，为NULL时线性探测
+} ArgParseIndex; // 名字到节点的哈希索引，节点中的索引指针为NULL时按顺序查找
+
+typedef struct ArgParseSlot {
+    const void *node;       // 节点地址，Command* 或 CommandArgs*
+    char      **val;        // 解析到的值，所有权见argParseSetBorrowValues
+    int         val_len;    // 解析到的值个数
+    int         val_cap;    // 值数组容量
+    bool        is_trigged; // 是否被触发
+} ArgParseSlot;             // 单个节点的解析结果
+
+typedef struct ArgParseSlots {
+    ArgParseSlot *entries;  // 开放寻址槽位
+    int           capacity; // 槽位数，始终为2的幂
+    int           len;      // 已占用槽位数
+} ArgParseSlots; // 节点地址到解析结果的哈希表，解析时不修改节点本身
+
+typedef struct ArgParseHelpEntry {
+    const struct Command *command; // 所属命令，全局帮助为NULL
+    char                 *text[2]; // 帮助文本，下标为是否带颜色，未生成时为NULL
+    size_t                len[2];  // 帮助文本长度
+} ArgParseHelpEntry;
+
+typedef struct ArgParseHelpCache {
+    ArgParseHelpEntry *entries; // 已生成过帮助的命令
+    int                len;     // 条目数
+    int                cap;     // 条目数组容量
+} ArgParseHelpCache; // 按命令与颜色缓存的帮助文本，规格变化时清空
+
+typedef struct ArgParseMapping {
+    void  *addr; // 起始地址
+    size_t size; // 长度
+} ArgParseMapping; // @file参数文件或规格文件在内存中的映射
+
+typedef struct ArgParseState {
+    bool              is_result;       // 是否为argParseParseResult的结果视图
+    struct Command   *current_command; // 当前解析到的命令
+    ArgParseSlots     results;         // 各命令与参数的解析结果
+    char            **val;             // 程序值
+    int               val_len;         // 程序值个数
+    int               val_cap;         // 值数组容量
+    int               argc;            // 参数个数
+    char            **argv;            // 参数列表，@file展开后指向expanded_argv
+    ArgParseToken    *tokens;          // 参数预分类结果，与argv一一对应
+    int               tokens_cap;      // 分类数组容量
+    char            **expanded_argv;   // @file展开后的参数列表
+    ArgParseMapping  *mappings;        // @file文件映射，argParseFree时释放
+    int               mappings_len;    // 映射个数
+    ArgParseErrorInfo error;           // 最近一次解析的错误
+    ArgParseStats     stats;           // 解析统计，见argParseGetStats
+    ArgParseHelpCache help_cache;      // 帮助文本缓存，见argParseGetHelp
+} ArgParseState; // 解析器的解析状态，与命令树分开，共享规格的每个结果各有一份
+
+struct ArgParseResult {
+    ArgParse      view;  // 规格的浅拷贝，命令树与索引仍与规格共用
+    ArgParseState state; // 视图的解析状态，独立于规格与其他结果
+};
+
+typedef enum {
+    SCAN_SCALAR, // 逐字节扫描
+    SCAN_SSE2,   // 每次比较16字节
+    SCAN_AVX2,   // 每次比较32字节
+} ArgParseScanLevel; // 参数分类的扫描级别，运行时按CPU选择
+
+Command *createCommand(ArgParse         *argParse,
+                       const char       *name,
                        const char       *help,
                        const char       *default_val,
                        ArgParseCallback  callback,
@@ -29,7 +171,8 @@ CommandGroup *createCommandGroup(const char *name,
 CommandGroup *addCommandToGroup(CommandGroup *group,
                                 Command      *command); // 添加命令到命令组
 
-CommandArgs *createCommandArgs(const char       *short_opt,
+CommandArgs *createCommandArgs(ArgParse         *argParse,
+                               const char       *short_opt,
                                const char       *long_opt,
                                const char       *default_val,
                                const char       *help,
@@ -39,34 +182,190 @@ CommandArgs *createCommandArgs(const char       *short_opt,
 
 /**
  * @brief 设置命令参数值
+ * @param argParse 解析器
  * @param args 参数
  * @param val 值
  * @return 成功返回true，失败返回false
  */
-bool argParseSetArgVal(CommandArgs *args, const char *val); // 设置命令参数值
+bool argParseSetArgVal(ArgParse    *argParse,
+                       CommandArgs *args,
+                       const char  *val); // 设置命令参数值
 
-bool argParseSetCommandVal(Command *command, const char *val); // 设置命令值
+bool argParseSetArgVals(ArgParse    *argParse,
+                        CommandArgs *args,
+                        char *const *vals,
+                        int          count); // 设置一段命令参数值
+
+bool argParseSetCommandVal(ArgParse   *argParse,
+                           Command    *command,
+                           const char *val); // 设置命令值
+
+bool argParseSetCommandVals(ArgParse    *argParse,
+                            Command     *command,
+                            char *const *vals,
+                            int          count); // 设置一段命令值
 
 bool argParseSetVal(ArgParse *argParse, const char *val); // 设置值
 
-ArgType checkArgType(char *arg); // 检查参数类型
+bool argParseSetVals(ArgParse    *argParse,
+                     char *const *vals,
+                     int          count); // 设置一段值
+
+int argParseCountValues(const ArgParseToken *tokens,
+                        int                  argc,
+                        int                  start); // 统计连续的值个数
+
+ArgParseSlot *argParseSlotFind(const ArgParseSlots *slots,
+                               const void          *node); // 查找节点解析结果
+
+ArgParseSlot *argParseSlotGet(ArgParse   *argParse,
+                              const void *node); // 获取或创建节点解析结果
+
+bool argParseMarkTriggered(ArgParse   *argParse,
+                           const void *node); // 标记节点被触发
+
+bool argParseIsTriggered(ArgParse   *argParse,
+                         const void *node); // 节点是否被触发
+
+char *argParseValueCopy(ArgParse   *argParse,
+                        const char *val); // 保存解析值，借用模式下不复制
+
+ArgParseScanLevel argParseScanLevel(); // 当前CPU支持的最高扫描级别
+
+void argParseScanTokens(ArgParseScanLevel level,
+                        char *const      *argv,
+                        int               count,
+                        ArgParseToken    *tokens); // 批量分类参数
+
+bool argParseTokenize(ArgParse *argParse); // 分类解析状态中argv的全部参数
+
+// 以下查找函数的token为name预先分类的结果，为NULL时现场计算哈希
+// 带'='的长选项只比较'='之前的部分
+Command *argParseFindCommand(ArgParse      *argParse,
+                             const char    *name,
+                             ArgParseToken *token); // 查找命令
+
+Command *argParseFindSubCommand(Command       *command,
+                                const char    *name,
+                                ArgParseToken *token); // 查找子命令
+
+CommandArgs *
+argParseFindCommandArgs(Command       *command,
+                        const char    *name,
+                        ArgParseToken *token); // 查找命令参数,长短选项均可
+
+CommandArgs *
+argParseFindGlobalArgs(ArgParse      *argParse,
+                       const char    *name,
+                       ArgParseToken *token); // 查找全局参数,长短选项均可
+
+bool argParseIndexInsert(ArgParse       *argParse,
+                         ArgParseIndex **index,
+                         const char     *key,
+                         void           *value); // 插入索引，首次插入时创建
+
+void *argParseIndexFind(const ArgParseIndex *index,
+                        const char          *key); // 查找索引
+
+void *argParseIndexLookup(const ArgParseIndex *index,
+                          const char          *key,
+                          size_t               key_len,
+                          unsigned int         hash); // 以已知长度与哈希查找索引
+
+void argParseIndexFree(ArgParse       *argParse,
+                       ArgParseIndex **index); // 释放索引并置为NULL
+
+unsigned int argParsePerfectBucket(unsigned int hash,
+                                   int          capacity); // 完美哈希中键所在的桶
+unsigned int argParsePerfectSlot(unsigned int   hash,
+                                 int            capacity,
+                                 unsigned short displace); // 完美哈希中键的槽位
+
+unsigned int __hashStr(const char *str); // 字符串哈希
+unsigned int __hashBytes(const char *str,
+                         size_t      len); // 已知长度的字符串哈希
+unsigned int __hashStrLen(const char *str,
+                          size_t     *len); // 字符串哈希，同时求长度
+
+ArgParseArena *argParseArenaCreate();                   // 创建内存池
+void *argParseArenaAlloc(ArgParseArena *arena, size_t size); // 从内存池分配
+void  argParseArenaDestroy(ArgParseArena *arena);            // 释放内存池
+
+void *argParseHeapAlloc(size_t size);              // 经由分配器分配堆内存
+void *argParseHeapRealloc(void *ptr, size_t size); // 经由分配器重新分配
+void  argParseHeapFree(void *ptr);                 // 经由分配器释放
+void *argParseMemAlloc(ArgParse *argParse, size_t size); // 分配解析器内存
+void *argParseMemRealloc(ArgParse *argParse,
+                         void     *ptr,
+                         size_t    old_size,
+                         size_t    size);            // 重新分配解析器内存
+void  argParseMemFree(ArgParse *argParse, void *ptr); // 释放解析器内存
+char *argParseMemStrCopy(ArgParse   *argParse,
+                         const char *str); // 在解析器内存中复制字符串
+void *argParseMemGrow(ArgParse *argParse,
+                      void     *array,
+                      int       len,
+                      size_t    elem_size); // 为追加元素扩容数组
+
+bool argParseExpandResponseFiles(ArgParse    *argParse,
+                                 int          argc,
+                                 char        *argv[],
+                                 const char **failed,
+                                 int *failed_index); // 展开@file参数
+void argParseReleaseResponseFiles(ArgParse *argParse); // 释放@file映射
+bool argParseMapFile(const char      *path,
+                     ArgParseMapping *mapping); // 私有可写地映射整个文件
+void argParseUnmapFile(ArgParseMapping *mapping); // 解除argParseMapFile的映射
+
+char  *stringNewCopy(const char *str); // 创建字符串副本
+size_t __getStrlen(const char *str);   // 获取字符串长度
+
+typedef struct StrBuilder {
+    char  *data; // 缓冲区，非空时始终以'\0'结尾
+    size_t len;  // 当前长度
+    size_t cap;  // 缓冲区容量
+} StrBuilder;    // 可增长的字符串构造器，追加代价与追加长度成正比
+
+void  strBuilderInit(StrBuilder *builder); // 初始化构造器
+bool  strBuilderAppendN(StrBuilder *builder,
+                        const char *str,
+                        size_t      len); // 追加指定长度的字符串
+bool  strBuilderAppend(StrBuilder *builder, int count, ...); // 追加多个字符串
+char *strBuilderDetach(StrBuilder *builder); // 取出字符串
+void  strBuilderFree(StrBuilder *builder);   // 释放构造器
+
+int  argParseAtomicLoad(const int *value);         // 以acquire语义读取
+void argParseAtomicStore(int *value, int desired); // 以release语义写入
+void argParseSpinLock(int *lock);                  // 获取自旋锁，等待时让出CPU
+void argParseSpinUnlock(int *lock);                // 释放自旋锁
+int  argParseAtomicAdd(int *value, int delta);     // 原子加，返回加之前的值
 
-Command *argParseFindCommand(ArgParse *argParse, const char *name); // 查找命令
+int argParseCpuCount(void); // 在线CPU个数，无法获取时为1
+int argParseRunWorkers(int threads,
+                       void (*run)(void *ctx),
+                       void *ctx); // 在多个线程中同时执行run，返回实际线程数
 
-Command *argParseFindSubCommand(Command    *command,
-                                const char *name); // 查找子命令
+#define TEXT_SINK_SPANS 64 // 写入文件描述符时每次writev聚集的片段数
 
-CommandArgs *argParseFindCommandArgs(Command    *command,
-                                     const char *name,
-                                     bool        short_flag); // 查找命令参数
+typedef struct TextSpan {
+    const char *data; // 片段起始
+    size_t      len;  // 片段长度
+} TextSpan;
 
-CommandArgs *argParseFindGlobalArgs(ArgParse   *argParse,
-                                    const char *name,
-                                    bool        short_flag); // 查找全局参数
+typedef struct TextSink {
+    StrBuilder *builder;                // 非NULL时追加到构造器
+    int         fd;                     // 否则聚集片段后写入该文件描述符
+    TextSpan    spans[TEXT_SINK_SPANS]; // 尚未写出的片段，只引用不复制
+    int         spans_len;              // 尚未写出的片段数
+    bool        ok;                     // 之前的追加与写入是否全部成功
+} TextSink; // 文本输出目标，写入文件描述符时占用的内存与文本长度无关
 
-char  *stringNewCopy(const char *str);       // 创建字符串副本
-void   __catStr(char **dst, int count, ...); // 字符串拼接
-size_t __getStrlen(const char *str);         // 获取字符串长度
+void textSinkInitBuilder(TextSink   *sink,
+                         StrBuilder *builder);     // 输出到字符串构造器
+void textSinkInitFd(TextSink *sink, int fd);       // 输出到文件描述符
+void textSinkInitFile(TextSink *sink, FILE *file); // 刷新file后输出到其描述符
+bool textSinkAppend(TextSink *sink, int count, ...); // 追加多个字符串
+bool textSinkFlush(TextSink *sink); // 写出聚集的片段
 
 #ifdef __cplusplus
 }
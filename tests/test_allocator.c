@@ -0,0 +1,90 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int mallocs;  // 分配次数
+    int reallocs; // 重新分配次数
+    int live;     // 尚未释放的块数
+} Pool;
+
+static void *poolMalloc(void *ctx, size_t size) {
+    Pool *pool = ctx;
+    pool->mallocs++;
+    pool->live++;
+    return malloc(size);
+}
+
+static void *poolRealloc(void *ctx, void *ptr, size_t size) {
+    Pool *pool = ctx;
+    pool->reallocs++;
+    if (ptr == NULL) {
+        pool->live++;
+    }
+    return realloc(ptr, size);
+}
+
+static void poolFree(void *ctx, void *ptr) {
+    Pool *pool = ctx;
+    pool->live--;
+    free(ptr);
+}
+
+int main(int argc, char *argv[]) {
+    // 自定义分配器接管规格、解析值与帮助信息的全部内存
+    Pool pool = {0, 0, 0};
+    argParseSetAllocator(poolMalloc, poolRealloc, poolFree, &pool);
+
+    ArgParse *argparse = initArgParse();
+    argParseParse(argparse, argc, argv);
+    assert(strcmp(argParseGetCurArg(argparse, "-i"), "www.test.com") == 0);
+    poolFree(&pool, argParseGenerateHelp(argparse));
+    argParseFree(argparse);
+
+    ArgParse *arena = argParseInitWithArena("arena", ArgParseNOVALUE);
+    argParseFree(arena);
+
+    printf("mallocs: %d reallocs: %d\n", pool.mallocs, pool.reallocs);
+    assert(pool.mallocs > 0);
+    assert(pool.live == 0);
+    argParseSetAllocator(NULL, NULL, NULL, NULL);
+
+    // 计数分配器分别统计构造规格与一次解析
+    ArgParseAllocStats stats;
+    argParseUseCountingAllocator(&stats);
+
+    argparse = initArgParse();
+    ArgParseAllocStats spec = stats;
+    assert(spec.count > 0);
+    assert(spec.bytes > 0 && spec.peak_bytes >= spec.bytes);
+
+    argParseAllocStatsBegin(&stats);
+    argParseParse(argparse, argc, argv);
+    ArgParseAllocStats parse = stats;
+    assert(parse.count > 0);
+    assert(parse.base_bytes == spec.bytes);
+    assert(parse.peak_bytes >= parse.bytes - parse.base_bytes);
+    printf("spec: %zu allocs %zu bytes, parse: %zu allocs %zu peak bytes\n",
+           spec.count,
+           spec.bytes,
+           parse.count,
+           parse.peak_bytes);
+
+    // 借用模式下重置后再次解析不需要新的内存
+    argParseReset(argparse);
+    argParseSetBorrowValues(argparse, true);
+    argParseParse(argparse, argc, argv);
+    argParseReset(argparse);
+    argParseAllocStatsBegin(&stats);
+    argParseParse(argparse, argc, argv);
+    assert(stats.count == 0);
+
+    argParseFree(argparse);
+    assert(stats.bytes == 0); // 全部内存都已归还
+    argParseUseCountingAllocator(NULL);
+
+    return 0;
+}
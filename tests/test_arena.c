@@ -0,0 +1,79 @@
+#include "ArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char *argv[]) {
+    ArgParse *argparse = argParseInitWithArena("测试程序", ArgParseNOVALUE);
+    Command  *command  = NULL;
+
+    argParseAddGlobalArg(argparse,
+                         "-v",
+                         "--version",
+                         "Show version",
+                         NULL,
+                         NULL,
+                         false,
+                         ArgParseNOVALUE);
+
+    command = argParseAddCommand(argparse,
+                                 "install",
+                                 "Install the package",
+                                 NULL,
+                                 NULL,
+                                 NULL,
+                                 ArgParseNOVALUE);
+    argParseAddArg(command,
+                   "-i",
+                   "--index",
+                   "Index URL",
+                   "https://example.com",
+                   NULL,
+                   false,
+                   ArgParseSINGLEVALUE);
+    argParseAddArg(command,
+                   "-p",
+                   "--package",
+                   "Package file",
+                   NULL,
+                   NULL,
+                   false,
+                   ArgParseMULTIVALUE);
+
+    // 足够多的命令使内存池跨越多个块
+    char name[32];
+    for (int i = 0; i < 2000; i++) {
+        snprintf(name, sizeof(name), "generated-%d", i);
+        Command *generated = argParseAddCommand(argparse,
+                                                name,
+                                                "Generated command",
+                                                NULL,
+                                                NULL,
+                                                NULL,
+                                                ArgParseNOVALUE);
+        argParseAddArg(generated,
+                       "-x",
+                       "--extra",
+                       "Generated option",
+                       NULL,
+                       NULL,
+                       false,
+                       ArgParseNOVALUE);
+    }
+
+    argParseParse(argparse, argc, argv);
+
+    assert(strcmp(argParseGetCurCommandName(argparse), "install") == 0);
+    assert(strcmp(argParseGetCurArg(argparse, "-i"), "www.test.com") == 0);
+
+    int    len      = 0;
+    char **packages = argParseGetCurArgList(argparse, "--package", &len);
+    assert(len == 3);
+    assert(strcmp(packages[0], "testpackge1") == 0);
+    assert(strcmp(packages[2], "testpackge3") == 0);
+    assert(argParseCheckGlobalTriggered(argparse, "--version"));
+
+    argParseFree(argparse);
+
+    return 0;
+}
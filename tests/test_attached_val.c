@@ -0,0 +1,91 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+// 静态规格没有索引，按长度比较名字
+static ArgParse parser = ARGPARSE_PARSER(
+    "测试程序",
+    ArgParseNOVALUE,
+    ARGPARSE_GLOBAL_ARGS(ARGPARSE_ARG("-o",
+                                      "--output",
+                                      "Output file",
+                                      NULL,
+                                      NULL,
+                                      false,
+                                      ArgParseSINGLEVALUE),
+                         ARGPARSE_ARG("-q",
+                                      "--quiet",
+                                      "Quiet mode",
+                                      NULL,
+                                      NULL,
+                                      false,
+                                      ArgParseNOVALUE)));
+
+int main(int argc, char *argv[]) {
+    ArgParse *argparse = initArgParse();
+    argParseSetExitOnError(argparse, false);
+    argParseSetBorrowValues(argparse, true);
+
+    // 附带的值直接指向argv中'='之后的位置
+    char *long_form[] = {
+        argv[0], "install", "--index=https://x", "--package=a", "b", "-v"};
+    ArgParseErrorKind code = argParseParse(argparse, 6, long_form);
+    assert(code == ArgParseOK);
+    assert(argParseGetCurArg(argparse, "-i") == long_form[2] + 8);
+    int    len      = 0;
+    char **packages = argParseGetCurArgList(argparse, "--package", &len);
+    assert(len == 2);
+    assert(strcmp(packages[0], "a") == 0 && strcmp(packages[1], "b") == 0);
+    assert(argParseCheckGlobalTriggered(argparse, "-v"));
+
+    // 短选项的值紧跟在选项名之后
+    argParseReset(argparse);
+    char *short_form[] = {argv[0], "install", "-iwww.test.com", "-px"};
+    code               = argParseParse(argparse, 4, short_form);
+    assert(code == ArgParseOK);
+    assert(strcmp(argParseGetCurArg(argparse, "--index"), "www.test.com") ==
+           0);
+    assert(strcmp(argParseGetCurArg(argparse, "-p"), "x") == 0);
+
+    // 空值与值中再次出现的'='
+    argParseReset(argparse);
+    char *empty[] = {argv[0], "install", "--index=", "--file=a=b"};
+    code          = argParseParse(argparse, 4, empty);
+    assert(code == ArgParseOK);
+    assert(strcmp(argParseGetCurArg(argparse, "-i"), "") == 0);
+    assert(strcmp(argParseGetCurArg(argparse, "-f"), "a=b") == 0);
+
+    // 无值选项不接受附带的值
+    argParseReset(argparse);
+    char *novalue[] = {argv[0], "--version=1"};
+    code            = argParseParse(argparse, 2, novalue);
+    assert(code == ArgParseBADARGUMENT);
+    assert(argParseGetError(argparse)->index == 1);
+
+    argParseReset(argparse);
+    char *unknown[] = {argv[0], "-vx"};
+    code            = argParseParse(argparse, 2, unknown);
+    assert(code == ArgParseUNKNOWNOPTION);
+
+    argParseReset(argparse);
+    char *prefix[] = {argv[0], "--versions=1"};
+    code           = argParseParse(argparse, 2, prefix);
+    assert(code == ArgParseUNKNOWNOPTION);
+    argParseFree(argparse);
+
+    char *static_form[] = {argv[0], "--output=out.txt", "-q"};
+    argParseParse(&parser, 3, static_form);
+    assert(strcmp(argParseGetGlobalArg(&parser, "-o"), "out.txt") == 0);
+    assert(argParseCheckGlobalTriggered(&parser, "--quiet"));
+    argParseFree(&parser);
+
+    char *static_short[] = {argv[0], "-oout.txt"};
+    argParseParse(&parser, 2, static_short);
+    assert(strcmp(argParseGetGlobalArg(&parser, "--output"), "out.txt") == 0);
+    argParseFree(&parser);
+
+    printf("attached values parsed\n");
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char *argv[]) {
+    ArgParse *argparse = initArgParse();
+    argParseSetBorrowValues(argparse, true);
+
+    argParseParse(argparse, argc, argv);
+
+    // 借用模式下值直接指向argv中的字符串
+    int    len      = 0;
+    char **packages = argParseGetCurArgList(argparse, "-p", &len);
+    assert(len == 3);
+    for (int i = 0; i < len; i++) {
+        printf("package: %s\n", packages[i]);
+        assert(packages[i] == argv[3 + i]);
+    }
+    assert(argParseGetCurArg(argparse, "--index") == argv[7]);
+
+    argParseFree(argparse);
+
+    // argv在解析器释放后仍然完好
+    assert(strcmp(argv[3], "testpackge1") == 0);
+
+    return 0;
+}
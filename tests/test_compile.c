@@ -0,0 +1,51 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char *argv[]) {
+    ArgParse *argparse = initArgParse();
+
+    bool compiled = argParseCompile(argparse);
+    assert(compiled);
+    compiled = argParseCompile(argparse); // 重复编译无副作用
+    assert(compiled);
+
+    // 同层命令节点在块中相邻存放
+    assert(argparse->commands_len == 2);
+    assert(argparse->commands[1] == argparse->commands[0] + 1);
+
+    // 编译后的规格不能再添加节点
+    assert(argParseAddCommand(
+               argparse, "x", "x", NULL, NULL, NULL, ArgParseNOVALUE) == NULL);
+    assert(argParseAddArg(argparse->commands[0],
+                          "-x",
+                          "--x",
+                          "x",
+                          NULL,
+                          NULL,
+                          false,
+                          ArgParseNOVALUE) == NULL);
+
+    argParseParse(argparse, argc, argv);
+
+    char *command_name = argParseGetCurCommandName(argparse);
+    printf("command name: %s\n", command_name);
+    assert(strcmp(command_name, "install") == 0);
+
+    int    len      = 0;
+    char **packages = argParseGetCurArgList(argparse, "--package", &len);
+    assert(len == 3);
+    for (int i = 0; i < len; i++) {
+        printf("package: %s\n", packages[i]);
+    }
+    assert(strcmp(argParseGetCurArg(argparse, "-i"), "www.test.com") == 0);
+    assert(argParseCheckGlobalTriggered(argparse, "--version"));
+    assert(argParseCheckCommandTriggered(argparse, "install"));
+    assert(!argParseCheckCommandTriggered(argparse, "uninstall"));
+
+    argParseFree(argparse);
+
+    return 0;
+}
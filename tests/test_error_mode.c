@@ -0,0 +1,183 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int _AllocsLeft = -1; // 之后还能成功的分配次数，为负时不限
+
+static bool allowAlloc(void) {
+    if (_AllocsLeft < 0) {
+        return true;
+    }
+    if (_AllocsLeft == 0) {
+        return false;
+    }
+    _AllocsLeft--;
+    return true;
+}
+
+static void *failingMalloc(void *ctx, size_t size) {
+    (void)ctx;
+    return allowAlloc() ? malloc(size) : NULL;
+}
+
+static void *failingRealloc(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    return allowAlloc() ? realloc(ptr, size) : NULL;
+}
+
+static void failingFree(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+// 解析一组参数并检查返回的结构化错误
+static void expectError(ArgParse         *argparse,
+                        int               argc,
+                        char             *argv[],
+                        ArgParseErrorKind kind,
+                        int               index,
+                        const char       *token,
+                        const char       *command) {
+    argParseReset(argparse);
+    ArgParseErrorKind code = argParseParse(argparse, argc, argv);
+    assert(code == kind);
+
+    const ArgParseErrorInfo *error = argParseGetError(argparse);
+    assert(error->kind == kind);
+    assert(error->index == index);
+    if (token == NULL) {
+        assert(error->token == NULL);
+    } else {
+        assert(strcmp(error->token, token) == 0);
+    }
+    if (command == NULL) {
+        assert(error->command == NULL);
+    } else {
+        assert(strcmp(error->command->name, command) == 0);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    ArgParse *argparse = initArgParse();
+    argParseSetExitOnError(argparse, false);
+
+    char *unknown_command[] = {argv[0], "unknow"};
+    expectError(argparse,
+                2,
+                unknown_command,
+                ArgParseUNKNOWNCOMMAND,
+                1,
+                "unknow",
+                NULL);
+
+    char *unknown_option[] = {argv[0], "install", "--unknow"};
+    expectError(argparse,
+                3,
+                unknown_option,
+                ArgParseUNKNOWNOPTION,
+                2,
+                "--unknow",
+                "install");
+
+    char *unknown_global[] = {argv[0], "-x"};
+    expectError(
+        argparse, 2, unknown_global, ArgParseUNKNOWNOPTION, 1, "-x", NULL);
+
+    char *unknown_sub[] = {argv[0], "install", "nosuch"};
+    expectError(argparse,
+                3,
+                unknown_sub,
+                ArgParseUNKNOWNCOMMAND,
+                2,
+                "nosuch",
+                "install");
+
+    char *incomplete[] = {argv[0], "install", "tools"};
+    expectError(
+        argparse, 3, incomplete, ArgParseINCOMPLETE, 2, "tools", "tools");
+
+    char *missing[] = {argv[0], "uninstall", "pkg"};
+    expectError(
+        argparse, 3, missing, ArgParseMISSINGREQUIRED, -1, "-p", "uninstall");
+
+    // 帮助选项只记录请求，不打印也不退出
+    char *help[] = {argv[0], "-v", "--help"};
+    expectError(argparse, 3, help, ArgParseHELP, 2, "--help", NULL);
+
+    char *command_help[] = {argv[0], "install", "-h"};
+    expectError(
+        argparse, 3, command_help, ArgParseHELP, 2, "-h", "install");
+
+    argParseSetResponseFiles(argparse, true);
+    char *response[] = {argv[0], "-v", "@test_error_mode_missing.rsp"};
+    expectError(argparse,
+                3,
+                response,
+                ArgParseRESPONSEFILE,
+                2,
+                "@test_error_mode_missing.rsp",
+                NULL);
+
+    // 出错后解析器仍然可用
+    char *good[] = {argv[0], "install", "-i", "www.test.com"};
+    expectError(argparse, 4, good, ArgParseOK, -1, NULL, NULL);
+    assert(strcmp(argParseGetCurArg(argparse, "-i"), "www.test.com") == 0);
+
+    // 共享规格的结果视图同样返回错误而不结束程序
+    ArgParseResult *result =
+        argParseParseResult(argParseGetSpec(argparse), 2, unknown_command);
+    assert(argParseResultGetError(result)->kind == ArgParseUNKNOWNCOMMAND);
+    assert(argParseGetError(argparse)->kind == ArgParseOK);
+    argParseResultFree(result);
+
+    argParseFree(argparse);
+
+    // 内存不足与参数错误区分开
+    argParseSetAllocator(failingMalloc, failingRealloc, failingFree, NULL);
+    argparse = initArgParse();
+    argParseSetExitOnError(argparse, false);
+    _AllocsLeft = 0;
+    expectError(argparse, 4, good, ArgParseNOMEMORY, -1, NULL, NULL);
+    _AllocsLeft = -1;
+    expectError(argparse, 4, good, ArgParseOK, -1, NULL, NULL);
+    argParseFree(argparse);
+
+    // 分类参数之后的记录触发与写入值失败同样返回ArgParseNOMEMORY，
+    // 而不是返回成功却只留下部分的值
+    char *values[] = {argv[0], "install", "-p", "x", "y"};
+    argparse       = initArgParse();
+    argParseSetExitOnError(argparse, false);
+    _AllocsLeft              = 1000;
+    ArgParseErrorKind parsed = argParseParse(argparse, 5, values);
+    int               needed = 1000 - _AllocsLeft;
+    _AllocsLeft              = -1;
+    assert(parsed == ArgParseOK);
+
+    int    len      = 0;
+    char **packages = argParseGetCurArgList(argparse, "-p", &len);
+    assert(packages != NULL && len == 2);
+    argParseFree(argparse);
+
+    bool after_tokenize = false;
+    for (int allowed = 0; allowed < needed; allowed++) {
+        argparse = initArgParse();
+        argParseSetExitOnError(argparse, false);
+        _AllocsLeft            = allowed;
+        ArgParseErrorKind kind = argParseParse(argparse, 5, values);
+        _AllocsLeft            = -1;
+        assert(kind == ArgParseNOMEMORY);
+        if (argParseGetError(argparse)->index > 0) {
+            after_tokenize = true;
+        }
+        argParseFree(argparse);
+    }
+    assert(after_tokenize);
+    argParseSetAllocator(NULL, NULL, NULL, NULL);
+
+    printf("all errors returned\n");
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "ArgParse.h"
+#include "ArgParseTools.h"
+#include "collisionSpec.h"
+#include "generatedSpec.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static CommandGroup group   = {"Remote", "Remote commands", NULL, 0};
+static int          fetched = 0;
+
+int onFetch(ArgParse *argParse, char **val, int val_len) {
+    fetched++;
+    return 0;
+}
+
+// 生成的每个索引都带有完美哈希位移表，子树同样如此
+static void checkIndexed(Command **commands, int len) {
+    for (int i = 0; i < len; i++) {
+        assert(commands[i]->args_index->displace != NULL);
+        assert(commands[i]->args_index->len == commands[i]->args_len * 2);
+        if (commands[i]->sub_commands_len > 0) {
+            assert(commands[i]->sub_commands_index->displace != NULL);
+        }
+        checkIndexed(commands[i]->sub_commands, commands[i]->sub_commands_len);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    ArgParse *spec = &generatedSpec;
+    assert(spec->commands_index->displace != NULL);
+    assert(spec->global_args_index->displace != NULL);
+    checkIndexed(spec->commands, spec->commands_len);
+
+    // 帮助信息与运行时构造的同一棵树逐字节一致
+    ArgParse *argparse = initArgParse();
+    argParseAddCommand(argparse,
+                       "fetch",
+                       "Fetch remote",
+                       NULL,
+                       onFetch,
+                       &group,
+                       ArgParseNOVALUE);
+    char *expect = argParseGenerateHelp(argparse);
+    char *help   = argParseGenerateHelp(spec);
+    assert(strcmp(help, expect) == 0);
+    free(help);
+    free(expect);
+    expect = argParseGenerateHelpForCommand(argparse->commands[0]);
+    help   = argParseGenerateHelpForCommand(spec->commands[0]);
+    assert(strcmp(help, expect) == 0);
+    free(help);
+    free(expect);
+    argParseFree(argparse);
+
+    char *args[] = {argv[0],
+                    "-q",
+                    "install",
+                    "--package=a",
+                    "b",
+                    "-iwww.test.com",
+                    "tools",
+                    "--tool",
+                    "gcc"};
+    int   code   = argParseParse(spec, 9, args);
+    assert(code == ArgParseOK);
+    assert(argParseCheckGlobalTriggered(spec, "--quiet"));
+    assert(!argParseCheckGlobalTriggered(spec, "-v"));
+    assert(argParseCheckCommandTriggered(spec, "install"));
+    assert(strcmp(argParseGetCurCommandName(spec), "tools") == 0);
+    assert(strcmp(argParseGetCurArg(spec, "-t"), "gcc") == 0);
+    argParseFree(spec);
+
+    char *fetch[] = {argv[0], "fetch"};
+    code          = argParseParse(spec, 2, fetch);
+    assert(code == ArgParseOK && fetched == 1);
+    assert(strcmp(spec->commands[2]->group->name, "Remote") == 0);
+    argParseFree(spec);
+
+    // 名字不在索引中时只比较一个槽位后返回
+    argParseSetExitOnError(spec, false);
+    char *unknown[] = {argv[0], "installs"};
+    code            = argParseParse(spec, 2, unknown);
+    assert(code == ArgParseUNKNOWNCOMMAND);
+    argParseReset(spec);
+    char *option[] = {argv[0], "uninstall", "--packages", "x"};
+    code           = argParseParse(spec, 4, option);
+    assert(code == ArgParseUNKNOWNOPTION);
+    argParseFree(spec);
+
+    // 哈希相同的两个选项名无法完美哈希，该索引按线性探测查找
+    spec = &collisionSpec;
+    assert(spec->commands_index->displace != NULL);
+    assert(spec->commands[0]->args_index->displace == NULL);
+    char *collide[] = {
+        argv[0], "run", "--opt-712382", "second", "--opt-549599", "first"};
+    code = argParseParse(spec, 6, collide);
+    assert(code == ArgParseOK);
+    assert(strcmp(argParseGetCurArg(spec, "-a"), "first") == 0);
+    assert(strcmp(argParseGetCurArg(spec, "-b"), "second") == 0);
+    argParseFree(spec);
+
+    printf("generated spec parsed\n");
+    return 0;
+}
@@ -0,0 +1,26 @@
+# 与initArgParse.h相同的命令树，另有一个命令组，供test_generated.c对照
+parser generatedSpec "测试程序" ArgParseNOVALUE
+
+group remote "Remote" "Remote commands"
+
+global -v --version "Show version" NULL NULL false ArgParseNOVALUE
+global -q --quiet "Quiet mode" NULL NULL false ArgParseNOVALUE
+
+command install "Install the package" NULL NULL NULL ArgParseNOVALUE
+    arg -i --index "Index URL" https://example.com NULL false ArgParseSINGLEVALUE
+    arg -f --file "Package file" package.json NULL false ArgParseMULTIVALUE
+    arg -p --package "Package file" package.json NULL false ArgParseMULTIVALUE
+    command tools "Install tools" NULL NULL NULL ArgParseMULTIVALUE
+        arg -t --tool "Tool name" "Tool name" NULL true ArgParseMULTIVALUE
+    end
+    command tools_sub "Install tools" NULL NULL NULL ArgParseMULTIVALUE
+        arg -s --source test_source "tools subcommand test" NULL true ArgParseMULTIVALUE
+    end
+end
+
+command uninstall "Uninstall the package" NULL NULL NULL ArgParseSINGLEVALUE
+    arg -p --package "Package name" "Package name" NULL true ArgParseMULTIVALUE
+end
+
+command fetch "Fetch remote" NULL onFetch remote ArgParseNOVALUE
+end
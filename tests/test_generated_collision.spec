@@ -0,0 +1,7 @@
+# 两个长选项名的FNV-1a哈希相同(0x1c0ea942)，run的参数索引改为线性探测
+parser collisionSpec "冲突测试" ArgParseNOVALUE
+
+command run "Run the job" NULL NULL NULL ArgParseNOVALUE
+    arg -a --opt-549599 "First option" NULL NULL false ArgParseSINGLEVALUE
+    arg -b --opt-712382 "Second option" NULL NULL false ArgParseSINGLEVALUE
+end
@@ -0,0 +1,77 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[]) {
+    // 缓存的彩色帮助与argParseGenerateHelp生成的内容一致
+    ArgParse   *argparse = initArgParse();
+    size_t      len      = 0;
+    const char *help     = argParseGetHelp(argparse, NULL, true, &len);
+    char       *expect   = argParseGenerateHelp(argparse);
+    assert(help != NULL && len == strlen(help));
+    assert(strcmp(help, expect) == 0);
+    free(expect);
+
+    // 再次获取直接返回同一缓冲区，无颜色版本单独缓存
+    assert(argParseGetHelp(argparse, NULL, true, NULL) == help);
+    const char *plain = argParseGetHelp(argparse, NULL, false, &len);
+    assert(plain != NULL && plain != help && len == strlen(plain));
+    assert(strchr(plain, '\033') == NULL);
+    assert(strstr(plain, "Global Options:") != NULL);
+
+    Command    *install = argparse->commands[0];
+    const char *usage   = argParseGetHelp(argparse, install, false, &len);
+    assert(strstr(usage, "Usage: install") != NULL);
+    assert(argParseGetHelp(argparse, install, false, NULL) == usage);
+    argParseFree(argparse);
+
+    // 命中缓存时不分配内存，添加参数后重新生成，释放后全部归还
+    ArgParseAllocStats stats;
+    argParseUseCountingAllocator(&stats);
+
+    argparse = initArgParse();
+    install  = argparse->commands[0];
+    argParseGetHelp(argparse, NULL, true, NULL);
+    argParseGetHelp(argparse, install, true, NULL);
+    argParseAllocStatsBegin(&stats);
+    argParseGetHelp(argparse, NULL, true, NULL);
+    argParseGetHelp(argparse, install, true, NULL);
+    assert(stats.count == 0);
+
+    argParseAddArg(install,
+                   "-t",
+                   "--timeout",
+                   "Timeout seconds",
+                   NULL,
+                   NULL,
+                   false,
+                   ArgParseSINGLEVALUE);
+    usage = argParseGetHelp(argparse, install, false, NULL);
+    assert(strstr(usage, "--timeout  Timeout seconds") != NULL);
+
+    // 编译后节点地址改变，按新节点重新生成
+    bool compiled = argParseCompile(argparse);
+    assert(compiled);
+    install = argparse->commands[0];
+    usage   = argParseGetHelp(argparse, install, false, NULL);
+    assert(strstr(usage, "--timeout") != NULL);
+
+    // 结果视图各自缓存，随结果一起释放
+    char           *args[] = {argv[0], "install"};
+    ArgParseResult *result =
+        argParseParseResult(argParseGetSpec(argparse), 2, args);
+    assert(argParseResultGetHelp(result, NULL, false, NULL) != NULL);
+    assert(argParseResultGetHelp(result, NULL, false, NULL) !=
+           argParseGetHelp(argparse, NULL, false, NULL));
+    argParseResultFree(result);
+
+    argParseFree(argparse);
+    assert(stats.bytes == 0);
+    argParseUseCountingAllocator(NULL);
+
+    printf("help cache reused\n");
+    return 0;
+}
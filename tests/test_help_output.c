@@ -0,0 +1,105 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// 读回文件描述符中已写入的全部内容并回到开头，由调用方释放
+static char *readBack(int fd) {
+    off_t size = lseek(fd, 0, SEEK_CUR);
+    char *text = malloc(size + 1);
+    ssize_t read = pread(fd, text, size, 0);
+    assert(read == size);
+    text[size] = '\0';
+    lseek(fd, 0, SEEK_SET);
+    return text;
+}
+
+// 直接写出的内容与生成的字符串逐字节一致
+static void checkSame(ArgParse *argparse, int fd) {
+    bool ok = argParseWriteHelp(argparse, NULL, true, fd);
+    assert(ok);
+    char *written = readBack(fd);
+    char *expect  = argParseGenerateHelp(argparse);
+    assert(strcmp(written, expect) == 0);
+    free(written);
+    free(expect);
+
+    ok = argParseWriteHelp(argparse, NULL, false, fd);
+    assert(ok);
+    written = readBack(fd);
+    assert(strcmp(written, argParseGetHelp(argparse, NULL, false, NULL)) ==
+           0);
+    free(written);
+
+    // 已缓存时写出缓存的内容
+    ok = argParseWriteHelp(argparse, NULL, false, fd);
+    assert(ok);
+    written = readBack(fd);
+    assert(strcmp(written, argParseGetHelp(argparse, NULL, false, NULL)) ==
+           0);
+    free(written);
+}
+
+int main(int argc, char *argv[]) {
+    FILE *file = tmpfile();
+    assert(file != NULL);
+    int fd = fileno(file);
+
+    ArgParse *argparse = initArgParse();
+    checkSame(argparse, fd);
+
+    Command *install = argparse->commands[0];
+    bool ok = argParseWriteHelp(NULL, install, true, fd);
+    assert(ok);
+    char *written = readBack(fd);
+    char *expect  = argParseGenerateHelpForCommand(install);
+    assert(strcmp(written, expect) == 0);
+    free(written);
+    free(expect);
+
+    // 先经由FILE缓冲的内容排在帮助信息之前
+    FILE *stream = tmpfile();
+    fprintf(stream, "before\n");
+    ok = argParsePrintHelp(argparse, install, false, stream);
+    assert(ok);
+    written = readBack(fileno(stream));
+    assert(strncmp(written, "before\nInstall the package", 26) == 0);
+    free(written);
+    fclose(stream);
+    argParseFree(argparse);
+
+    // 片段数远超单次writev的批量，流式输出时不分配内存
+    ArgParseAllocStats stats;
+    argParseUseCountingAllocator(&stats);
+    argparse = argParseInit("big", ArgParseNOVALUE);
+    char name[32];
+    for (int i = 0; i < 500; i++) {
+        snprintf(name, sizeof(name), "command-%d", i);
+        argParseAddCommand(argparse,
+                           name,
+                           "Generated command",
+                           NULL,
+                           NULL,
+                           NULL,
+                           ArgParseNOVALUE);
+    }
+    argParseAllocStatsBegin(&stats);
+    ok = argParseWriteHelp(argparse, NULL, true, fd);
+    assert(ok && stats.count == 0);
+
+    written = readBack(fd);
+    assert(strcmp(written, argParseGetHelp(argparse, NULL, true, NULL)) == 0);
+    free(written);
+    argParseFree(argparse);
+    assert(stats.bytes == 0);
+    argParseUseCountingAllocator(NULL);
+
+    ok = argParseWriteHelp(NULL, NULL, true, fd);
+    assert(!ok);
+    fclose(file);
+    printf("help written without intermediate buffers\n");
+    return 0;
+}
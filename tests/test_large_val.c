@@ -0,0 +1,98 @@
+#include "ArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_VALUES 1000000
+#define RUNS       100000
+#define MAX_ALLOCS 64 // 与值个数无关的分配次数上限，结果表、分类数组等
+
+static char *_argv[MAX_VALUES + 1];
+static char  _buffer[MAX_VALUES * 16];
+
+static ArgParseAllocStats _Stats;
+
+// 解析count个位置值，返回解析期间的分配次数
+static size_t parseValues(int count, bool borrow) {
+    ArgParse *argparse = argParseInit("测试程序", ArgParseMULTIVALUE);
+    argParseSetBorrowValues(argparse, borrow);
+
+    argParseAllocStatsBegin(&_Stats);
+    argParseParse(argparse, count + 1, _argv);
+    size_t allocs = _Stats.count;
+
+    int    len  = 0;
+    char **vals = argParseGetValList(argparse, &len);
+    assert(len == count);
+    assert(strcmp(vals[0], "file-0") == 0);
+    assert(strcmp(vals[count - 1], _argv[count]) == 0);
+
+    argParseFree(argparse);
+    printf("%d values%s: %zu allocations\n",
+           count,
+           borrow ? " (borrowed)" : "",
+           allocs);
+    return allocs;
+}
+
+// 同一多值选项出现runs次，每次追加一个值，返回解析期间的分配次数
+static size_t parseRuns(int runs) {
+    ArgParse *argparse = argParseInit("测试程序", ArgParseNOVALUE);
+    argParseSetBorrowValues(argparse, true);
+    argParseAddGlobalArg(argparse,
+                         "-f",
+                         "--file",
+                         "Input file",
+                         NULL,
+                         NULL,
+                         false,
+                         ArgParseMULTIVALUE);
+
+    static char *args[RUNS * 2 + 1];
+    args[0] = _argv[0];
+    for (int i = 0; i < runs; i++) {
+        args[i * 2 + 1] = "-f";
+        args[i * 2 + 2] = _argv[i + 1];
+    }
+
+    argParseAllocStatsBegin(&_Stats);
+    argParseParse(argparse, runs * 2 + 1, args);
+    size_t allocs = _Stats.count;
+
+    int    len   = 0;
+    char **files = argParseGetGlobalArgList(argparse, "-f", &len);
+    assert(len == runs);
+    assert(strcmp(files[runs - 1], _argv[runs]) == 0);
+
+    argParseFree(argparse);
+    printf("%d appended runs: %zu allocations\n", runs, allocs);
+    return allocs;
+}
+
+int main(int argc, char *argv[]) {
+    char *cursor = _buffer;
+    _argv[0]     = argv[0];
+    for (int i = 1; i <= MAX_VALUES; i++) {
+        _argv[i] = cursor;
+        cursor += sprintf(cursor, "file-%d", i - 1) + 1;
+    }
+    argParseUseCountingAllocator(&_Stats);
+
+    // 一段连续的值一次预留，值数组的分配次数与值个数无关
+    size_t allocs = parseValues(MAX_VALUES, true);
+    assert(allocs <= MAX_ALLOCS);
+    allocs = parseValues(MAX_VALUES / 4, true);
+    assert(allocs <= MAX_ALLOCS);
+
+    // 复制模式下每个值只多一次复制
+    allocs = parseValues(MAX_VALUES, false);
+    assert(allocs <= MAX_VALUES + MAX_ALLOCS);
+
+    // 逐段追加时按倍数扩容，扩容次数是对数级的
+    allocs = parseRuns(RUNS);
+    assert(allocs <= MAX_ALLOCS);
+
+    argParseUseCountingAllocator(NULL);
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "ArgParse.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TOOLS   100
+#define THREADS 8
+
+static int       _RemoteBuilds = 0;
+static int       _AddBuilds    = 0;
+static int       _ToolBuilds   = 0;
+static ArgParse *_Spec         = NULL;
+
+static void buildAdd(Command *command, void *ctx) {
+    (*(int *)ctx)++;
+    argParseAddArg(command,
+                   "-n",
+                   "--name",
+                   "Remote name",
+                   NULL,
+                   NULL,
+                   true,
+                   ArgParseSINGLEVALUE);
+}
+
+// 构造回调中可以继续添加延迟构造的子命令
+static void buildRemote(Command *command, void *ctx) {
+    (*(int *)ctx)++;
+    argParseAddArg(command,
+                   "-v",
+                   "--verbose",
+                   "Verbose output",
+                   NULL,
+                   NULL,
+                   false,
+                   ArgParseNOVALUE);
+    argParseAddLazySubCommand(
+        command, "add", "Add a remote", buildAdd, &_AddBuilds);
+}
+
+static void buildTool(Command *command, void *ctx) {
+    __atomic_fetch_add((int *)ctx, 1, __ATOMIC_RELAXED);
+    argParseAddArg(command,
+                   "-o",
+                   "--output",
+                   "Output file",
+                   NULL,
+                   NULL,
+                   false,
+                   ArgParseSINGLEVALUE);
+}
+
+static void *parseWorker(void *data) {
+    char *argv[] = {"lazy", "tool-7", "-o", "out.txt"};
+    for (int i = 0; i < 100; i++) {
+        ArgParseResult *result =
+            argParseParseResult(argParseGetSpec(_Spec), 4, argv);
+        assert(argParseResultGetError(result)->kind == ArgParseOK);
+        assert(strcmp(argParseResultGetCurArg(result, "-o"), "out.txt") == 0);
+        argParseResultFree(result);
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    _Spec = argParseInit("lazy", ArgParseNOVALUE);
+    argParseSetExitOnError(_Spec, false);
+    argParseAddLazyCommand(
+        _Spec, "remote", "Manage remotes", buildRemote, &_RemoteBuilds);
+    char name[32];
+    for (int i = 0; i < TOOLS; i++) {
+        snprintf(name, sizeof(name), "tool-%d", i);
+        argParseAddLazyCommand(
+            _Spec, name, "Generated tool", buildTool, &_ToolBuilds);
+    }
+
+    // 全局帮助只列出命令名，不构造任何命令
+    const char *help = argParseGetHelp(_Spec, NULL, false, NULL);
+    assert(strstr(help, "tool-99  Generated tool") != NULL);
+    assert(_RemoteBuilds == 0 && _ToolBuilds == 0);
+
+    // 只构造分派经过的命令
+    char *remote[]         = {"lazy", "remote", "add", "-n", "origin"};
+    ArgParseErrorKind code = argParseParse(_Spec, 5, remote);
+    assert(code == ArgParseOK);
+    assert(strcmp(argParseGetCurCommandName(_Spec), "add") == 0);
+    assert(strcmp(argParseGetCurArg(_Spec, "--name"), "origin") == 0);
+    assert(_RemoteBuilds == 1 && _AddBuilds == 1 && _ToolBuilds == 0);
+
+    argParseReset(_Spec);
+    code = argParseParse(_Spec, 5, remote);
+    assert(code == ArgParseOK);
+    assert(_RemoteBuilds == 1 && _AddBuilds == 1);
+
+    // 构造时自动添加帮助参数
+    argParseReset(_Spec);
+    char *tool_help[] = {"lazy", "tool-3", "-h"};
+    code              = argParseParse(_Spec, 3, tool_help);
+    assert(code == ArgParseHELP);
+    assert(_ToolBuilds == 1);
+
+    // 命令帮助需要完整的参数列表
+    Command *tool = _Spec->commands[1];
+    help          = argParseGetHelp(_Spec, tool, false, NULL);
+    assert(strstr(help, "-o , --output  Output file") != NULL);
+    assert(_ToolBuilds == 2);
+
+    // 多个线程同时分派到同一个未构造的命令时只构造一次
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        pthread_create(&threads[i], NULL, parseWorker, NULL);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(_ToolBuilds == 3);
+
+    // 编译前构造全部命令
+    bool frozen = argParseCompile(_Spec);
+    assert(frozen && _ToolBuilds == TOOLS);
+    argParseReset(_Spec);
+    char *compiled[] = {"lazy", "tool-50", "--output", "x"};
+    code             = argParseParse(_Spec, 4, compiled);
+    assert(code == ArgParseOK);
+    assert(strcmp(argParseGetCurArg(_Spec, "-o"), "x") == 0);
+    argParseFree(_Spec);
+
+    printf("lazy commands built on demand\n");
+    return 0;
+}
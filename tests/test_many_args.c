@@ -0,0 +1,41 @@
+#include "ArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define ARGS_COUNT 300
+
+int main(int argc, char *argv[]) {
+    ArgParse *argparse = argParseInit("测试程序", ArgParseNOVALUE);
+    Command  *command  = argParseAddCommand(
+        argparse, "build", "Build target", NULL, NULL, NULL, ArgParseNOVALUE);
+
+    char short_opt[16];
+    char long_opt[32];
+    for (int i = 0; i < ARGS_COUNT; i++) {
+        snprintf(short_opt, sizeof(short_opt), "-o%d", i);
+        snprintf(long_opt, sizeof(long_opt), "--option-%d", i);
+        argParseAddArg(command,
+                       short_opt,
+                       long_opt,
+                       "Generated option",
+                       NULL,
+                       NULL,
+                       false,
+                       ArgParseSINGLEVALUE);
+    }
+
+    argParseParse(argparse, argc, argv);
+
+    // 长短选项名均可取到同一参数
+    assert(strcmp(argParseGetCurArg(argparse, "-o7"), "seven") == 0);
+    assert(strcmp(argParseGetCurArg(argparse, "--option-7"), "seven") == 0);
+    assert(strcmp(argParseGetCurArg(argparse, "-o299"), "last") == 0);
+    assert(argParseCheckCurArgTriggered(argparse, "--option-299"));
+    assert(!argParseCheckCurArgTriggered(argparse, "-o150"));
+    assert(argParseGetCurArg(argparse, "--option-300") == NULL);
+
+    argParseFree(argparse);
+
+    return 0;
+}
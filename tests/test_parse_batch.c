@@ -0,0 +1,138 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINES     5000
+#define PATTERNS  7
+#define RSP_PATH  "CArgParseTest_batch.rsp"
+#define INDEX_LEN 16
+
+static char  _Index[LINES][INDEX_LEN];
+static char *_Argv[LINES][8];
+
+// 按行号轮流生成成功、各类错误与@file展开的命令行
+static ArgParseArgv makeLine(int i) {
+    char **argv = _Argv[i];
+    snprintf(_Index[i], INDEX_LEN, "index-%d", i);
+    argv[0] = "test";
+    switch (i % PATTERNS) {
+    case 0:
+        argv[1] = "install";
+        argv[2] = "-p";
+        argv[3] = "a";
+        argv[4] = "b";
+        argv[5] = "-i";
+        argv[6] = _Index[i];
+        return (ArgParseArgv){7, argv};
+    case 1:
+        argv[1] = "install";
+        argv[2] = "tools";
+        argv[3] = "-t";
+        argv[4] = _Index[i];
+        return (ArgParseArgv){5, argv};
+    case 2:
+        argv[1] = "install";
+        argv[2] = "tools";
+        return (ArgParseArgv){3, argv};
+    case 3:
+        argv[1] = "bogus";
+        return (ArgParseArgv){2, argv};
+    case 4:
+        argv[1] = "install";
+        argv[2] = "--nope";
+        return (ArgParseArgv){3, argv};
+    case 5:
+        argv[1] = "install";
+        argv[2] = "-h";
+        return (ArgParseArgv){3, argv};
+    default:
+        argv[1] = "@" RSP_PATH;
+        return (ArgParseArgv){2, argv};
+    }
+}
+
+int main(int argc, char *argv[]) {
+    FILE *rsp = fopen(RSP_PATH, "w");
+    fputs("install --from-file\n", rsp);
+    fclose(rsp);
+
+    ArgParse           *spec   = initArgParse();
+    const ArgParseSpec *shared = argParseGetSpec(spec);
+    argParseSetResponseFiles(spec, true);
+
+    static ArgParseArgv      lines[LINES];
+    static ArgParseErrorInfo expect[LINES];
+    static ArgParseErrorInfo results[LINES];
+    static const Command    *commands[LINES];
+    int                      expect_failed = 0;
+
+    // 逐条用argParseParseResult得到期望的结论
+    argParseSetExitOnError(spec, false);
+    for (int i = 0; i < LINES; i++) {
+        lines[i]               = makeLine(i);
+        ArgParseResult *result =
+            argParseParseResult(shared, lines[i].argc, lines[i].argv);
+        expect[i]              = *argParseResultGetError(result);
+        commands[i]            = argParseResultGetCurCommand(result);
+        if (expect[i].kind != ArgParseOK) {
+            expect_failed++;
+        }
+        argParseResultFree(result);
+    }
+    assert(expect[0].kind == ArgParseOK && expect[1].kind == ArgParseOK);
+    assert(expect[2].kind == ArgParseINCOMPLETE);
+    assert(expect[3].kind == ArgParseUNKNOWNCOMMAND);
+    assert(expect[4].kind == ArgParseUNKNOWNOPTION && expect[4].index == 2);
+    assert(expect[5].kind == ArgParseHELP);
+    assert(expect[6].kind == ArgParseUNKNOWNOPTION);
+
+    // 规格保持默认的出错退出，批量解析也只记录结论
+    argParseSetExitOnError(spec, true);
+    int thread_counts[] = {1, 3, 8, 0};
+    for (int t = 0; t < 4; t++) {
+        memset(results, 0xff, sizeof(results));
+        int failed = argParseParseBatch(
+            shared, lines, LINES, thread_counts[t], results);
+        assert(failed == expect_failed);
+
+        for (int i = 0; i < LINES; i++) {
+            assert(results[i].kind == expect[i].kind);
+            assert(results[i].index == expect[i].index);
+            if (results[i].kind == ArgParseOK) {
+                assert(results[i].command == commands[i]);
+                assert(results[i].token == NULL);
+            } else if (i % PATTERNS == PATTERNS - 1) {
+                // 出错参数位于已解除的@file映射中
+                assert(results[i].token == NULL);
+                assert(results[i].command == expect[i].command);
+            } else {
+                assert(results[i].token == expect[i].token);
+                assert(results[i].command == expect[i].command);
+            }
+        }
+    }
+    assert(strcmp(results[4].token, "--nope") == 0);
+    assert(strcmp(results[1].command->name, "tools") == 0);
+
+    // 编译后的规格同样可以批量解析
+    bool compiled = argParseCompile(spec);
+    assert(compiled);
+    int failed = argParseParseBatch(shared, lines, LINES, 4, results);
+    assert(failed == expect_failed);
+    assert(strcmp(results[0].command->name, "install") == 0);
+
+    failed = argParseParseBatch(shared, lines, 0, 4, NULL);
+    assert(failed == 0);
+    failed = argParseParseBatch(NULL, lines, LINES, 4, results);
+    assert(failed == -1);
+    failed = argParseParseBatch(shared, NULL, LINES, 4, results);
+    assert(failed == -1);
+
+    argParseFree(spec);
+    remove(RSP_PATH);
+    printf("batch parsed %d lines, %d failed\n", LINES, expect_failed);
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char *argv[]) {
+    ArgParse *argparse = initArgParse();
+
+    argParseParse(argparse, argc, argv);
+
+    int    len      = 0;
+    char **packages = argParseGetCurArgList(argparse, "-p", &len);
+    assert(len == 3);
+    assert(argParseCheckGlobalTriggered(argparse, "-v"));
+
+    // 重置后用同一解析器解析另一组参数
+    char *second[] = {argv[0], "install", "-p", "pkg-a", "pkg-b"};
+    for (int round = 0; round < 3; round++) {
+        argParseReset(argparse);
+        assert(argParseGetCurCommandName(argparse) == NULL);
+        assert(!argParseCheckCommandTriggered(argparse, "install"));
+
+        argParseParse(argparse, 5, second);
+
+        char **reused = argParseGetCurArgList(argparse, "-p", &len);
+        assert(len == 2);
+        assert(reused == packages); // 值数组被复用
+        assert(strcmp(reused[0], "pkg-a") == 0);
+        assert(strcmp(reused[1], "pkg-b") == 0);
+        printf("round %d: %s %s\n", round, reused[0], reused[1]);
+
+        // 上一次解析触发的选项不再保留
+        assert(!argParseCheckGlobalTriggered(argparse, "-v"));
+        assert(!argParseCheckCurArgTriggered(argparse, "-i"));
+        assert(argParseGetCurArg(argparse, "-i") == NULL);
+    }
+
+    argParseFree(argparse);
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define RESPONSE_FILE "test_response_file.rsp"
+#define NESTED_FILE   "test_response_nested.rsp"
+#define PATHS         50000
+
+static void writeFile(const char *path, const char *content) {
+    FILE *file = fopen(path, "wb");
+    assert(file != NULL);
+    fputs(content, file);
+    fclose(file);
+}
+
+int main(int argc, char *argv[]) {
+    // 引号、转义与嵌套@file
+    writeFile(NESTED_FILE, "-i 'www.test.com'");
+    writeFile(RESPONSE_FILE,
+              "install\n"
+              "  -p \"first package\" second\\ package third\r\n"
+              "@" NESTED_FILE);
+
+    ArgParse *argparse = initArgParse();
+    argParseSetResponseFiles(argparse, true);
+    argParseSetBorrowValues(argparse, true);
+
+    char *args[] = {argv[0], "-v", "@" RESPONSE_FILE};
+    argParseParse(argparse, 3, args);
+
+    assert(strcmp(argParseGetCurCommandName(argparse), "install") == 0);
+    assert(argParseCheckGlobalTriggered(argparse, "-v"));
+    int    len      = 0;
+    char **packages = argParseGetCurArgList(argparse, "-p", &len);
+    assert(len == 3);
+    assert(strcmp(packages[0], "first package") == 0);
+    assert(strcmp(packages[1], "second package") == 0);
+    assert(strcmp(packages[2], "third") == 0);
+    assert(strcmp(argParseGetCurArg(argparse, "--index"), "www.test.com") == 0);
+
+    // 大量值超出命令行长度限制时通过文件传入
+    argParseReset(argparse);
+    FILE *file = fopen(RESPONSE_FILE, "wb");
+    assert(file != NULL);
+    fputs("install -p", file);
+    for (int i = 0; i < PATHS; i++) {
+        fprintf(file, " src/module_%d/file_%d.c", i / 100, i);
+    }
+    fclose(file);
+
+    char *many[] = {argv[0], "@" RESPONSE_FILE};
+    argParseParse(argparse, 2, many);
+    packages = argParseGetCurArgList(argparse, "-p", &len);
+    printf("paths: %d\n", len);
+    assert(len == PATHS);
+    assert(strcmp(packages[PATHS - 1], "src/module_499/file_49999.c") == 0);
+
+    // 不经argParseReset再次解析时多值选项继续追加，上一次借用的值仍然有效
+    argParseParse(argparse, 2, many);
+    packages = argParseGetCurArgList(argparse, "-p", &len);
+    assert(len == PATHS * 2);
+    assert(strcmp(packages[0], "src/module_0/file_0.c") == 0);
+    assert(strcmp(packages[PATHS], "src/module_0/file_0.c") == 0);
+
+    argParseFree(argparse);
+    remove(RESPONSE_FILE);
+    remove(NESTED_FILE);
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SPEC_PATH "CArgParseTest_spec.bin"
+#define BAD_PATH  "CArgParseTest_spec_bad.bin"
+
+static CommandGroup group = {"Remote", "Remote commands", NULL, 0};
+
+// 与src/ArgParse.c中SpecHeader的布局相同，用于构造校验和正确但结构非法的文件
+typedef struct SpecHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint16_t sizes[5];
+    uint64_t checksum;
+    uint64_t size;
+    int32_t  command_nodes;
+    int32_t  arg_nodes;
+    int32_t  index_nodes;
+    int32_t  entry_slots;
+    int32_t  group_nodes;
+    uint32_t value_type;
+    uint64_t strings;
+    char    *documentation;
+    void    *commands;
+    int32_t  commands_len;
+    int32_t  global_args_len;
+    void    *commands_index;
+    void    *global_args;
+    void    *global_args_index;
+} SpecHeader;
+
+typedef struct SpecIndex {
+    void *entries;
+    int   capacity;
+    int   len;
+    void *displace;
+} SpecIndex; // 与ArgParseIndex的布局相同
+
+// 按新的长度重新计算校验和，与加载时的算法相同
+static void resign(char *data, size_t size) {
+    SpecHeader *header = (SpecHeader *)data;
+    uint64_t    hash   = 14695981039346656037ull;
+    header->size       = size;
+    header->checksum   = 0;
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    header->checksum = hash;
+}
+
+static void buildRemote(Command *command, void *ctx) {
+    argParseAddArg(command,
+                   "-n",
+                   "--name",
+                   "Remote name",
+                   NULL,
+                   NULL,
+                   true,
+                   ArgParseSINGLEVALUE);
+}
+
+static int onPush(ArgParse *argParse, char **val, int val_len) { return 0; }
+
+static Command *findCommand(ArgParse *argparse, const char *name) {
+    for (int i = 0; i < argparse->commands_len; i++) {
+        if (strcmp(argparse->commands[i]->name, name) == 0) {
+            return argparse->commands[i];
+        }
+    }
+    return NULL;
+}
+
+// 读入整个文件，由调用方释放
+static char *readFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    assert(file != NULL);
+    fseek(file, 0, SEEK_END);
+    *size      = (size_t)ftell(file);
+    char *data = malloc(*size);
+    fseek(file, 0, SEEK_SET);
+    size_t read = fread(data, 1, *size, file);
+    assert(read == *size);
+    fclose(file);
+    return data;
+}
+
+// 写入修改过的副本后加载，应当被拒绝
+static void checkRejected(const char *data, size_t size) {
+    FILE *file = fopen(BAD_PATH, "wb");
+    fwrite(data, 1, size, file);
+    fclose(file);
+    ArgParse *loaded = argParseLoadSpec(BAD_PATH);
+    assert(loaded == NULL);
+}
+
+int main(int argc, char *argv[]) {
+    ArgParse *argparse = initArgParse();
+    argParseAddLazyCommand(
+        argparse, "remote", "Manage remotes", buildRemote, NULL);
+    argParseAddCommand(
+        argparse, "fetch", "Fetch remote", NULL, NULL, &group, ArgParseNOVALUE);
+    argParseAddCommand(
+        argparse, "push", "Push remote", NULL, NULL, &group, ArgParseNOVALUE);
+    bool saved = argParseSaveSpec(argparse, SPEC_PATH);
+    assert(saved);
+    char *expect = argParseGenerateHelp(argparse);
+    argParseFree(argparse);
+
+    // 加载只分配解析器本身，树直接位于映射中
+    ArgParseAllocStats stats;
+    argParseUseCountingAllocator(&stats);
+    ArgParse *loaded = argParseLoadSpec(SPEC_PATH);
+    assert(loaded != NULL);
+    assert(stats.count == 1);
+
+    assert(strcmp(argParseGetHelp(loaded, NULL, true, NULL), expect) == 0);
+    free(expect);
+
+    // 命令组保存一次，两个命令指向同一节点
+    Command *fetch = findCommand(loaded, "fetch");
+    Command *push  = findCommand(loaded, "push");
+    assert(fetch->group == push->group && fetch->group != &group);
+    assert(strcmp(fetch->group->name, "Remote") == 0);
+    assert(fetch->parser == loaded);
+
+    char *args[] = {
+        argv[0], "install", "-p", "a", "b", "--index", "www.test.com", "-v"};
+    int   code   = argParseParse(loaded, 8, args);
+    assert(code == ArgParseOK);
+    assert(strcmp(argParseGetCurCommandName(loaded), "install") == 0);
+    assert(strcmp(argParseGetCurArg(loaded, "-i"), "www.test.com") == 0);
+    int    len      = 0;
+    char **packages = argParseGetCurArgList(loaded, "-p", &len);
+    assert(len == 2 && strcmp(packages[1], "b") == 0);
+    assert(argParseCheckGlobalTriggered(loaded, "--version"));
+
+    // 延迟构造的命令已在保存前构造
+    argParseReset(loaded);
+    char *remote[] = {argv[0], "remote", "--name", "origin"};
+    code           = argParseParse(loaded, 4, remote);
+    assert(code == ArgParseOK);
+    assert(strcmp(argParseGetCurArg(loaded, "-n"), "origin") == 0);
+
+    // 自动添加的帮助回调随文件恢复
+    argParseReset(loaded);
+    argParseSetExitOnError(loaded, false);
+    char *ask_help[] = {argv[0], "install", "-h"};
+    code             = argParseParse(loaded, 3, ask_help);
+    assert(code == ArgParseHELP);
+
+    // 加载的规格与编译后的规格一样只读，可直接共享给结果视图
+    assert(argParseAddCommand(
+               loaded, "new", "New", NULL, NULL, NULL, ArgParseNOVALUE) ==
+           NULL);
+    ArgParseResult *result =
+        argParseParseResult(argParseGetSpec(loaded), 4, remote);
+    assert(strcmp(argParseResultGetCurArg(result, "--name"), "origin") == 0);
+    argParseResultFree(result);
+    argParseFree(loaded);
+    assert(stats.bytes == 0);
+    argParseUseCountingAllocator(NULL);
+
+    // 编译后的规格保存出同样的文件
+    argparse = initArgParse();
+    saved           = argParseSaveSpec(argparse, BAD_PATH);
+    size_t size     = 0;
+    size_t compiled = 0;
+    char  *plain    = readFile(BAD_PATH, &size);
+    saved           = saved && argParseCompile(argparse);
+    saved           = saved && argParseSaveSpec(argparse, BAD_PATH);
+    assert(saved);
+    char *packed = readFile(BAD_PATH, &compiled);
+    assert(size == compiled && memcmp(plain, packed, size) == 0);
+    free(plain);
+    free(packed);
+    argParseFree(argparse);
+
+    // 带有用户回调的规格不能保存，不会生成回调静默丢失的文件
+    remove(BAD_PATH);
+    argparse = initArgParse();
+    argParseAddCommand(
+        argparse, "push", "Push remote", NULL, onPush, NULL, ArgParseNOVALUE);
+    saved = argParseSaveSpec(argparse, BAD_PATH);
+    assert(!saved);
+    assert(fopen(BAD_PATH, "rb") == NULL);
+    argParseFree(argparse);
+
+    // 损坏、截断或标识不符的文件都不能加载
+    char *data = readFile(SPEC_PATH, &size);
+    data[size / 2] ^= 0x20;
+    checkRejected(data, size);
+    data[size / 2] ^= 0x20;
+    checkRejected(data, size - 8);
+    data[0] = 'X';
+    checkRejected(data, size);
+    free(data);
+
+    // 校验和正确但长度、索引槽位越界的文件同样不能加载
+    data               = readFile(SPEC_PATH, &size);
+    SpecHeader *header = (SpecHeader *)data;
+    resign(data, size);
+    FILE *file = fopen(BAD_PATH, "wb");
+    fwrite(data, 1, size, file);
+    fclose(file);
+    loaded = argParseLoadSpec(BAD_PATH);
+    assert(loaded != NULL);
+    argParseFree(loaded);
+
+    header->commands_len = header->command_nodes + 1;
+    resign(data, size);
+    checkRejected(data, size);
+    header->commands_len    = 0;
+    header->global_args_len = -1;
+    resign(data, size);
+    checkRejected(data, size);
+    free(data);
+
+    data   = readFile(SPEC_PATH, &size);
+    header = (SpecHeader *)data;
+    assert(header->commands_index != NULL);
+    SpecIndex *index = (SpecIndex *)(data + (uintptr_t)header->commands_index);
+    index->capacity  = 1 << 20;
+    resign(data, size);
+    checkRejected(data, size);
+    index->capacity = index->len;
+    resign(data, size);
+    checkRejected(data, size);
+    free(data);
+    loaded = argParseLoadSpec("CArgParseTest_missing.bin");
+    assert(loaded == NULL);
+
+    remove(SPEC_PATH);
+    remove(BAD_PATH);
+    printf("spec file loaded\n");
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "ArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+// 与initArgParse.h相同的命令树，但在编译期静态声明
+static ArgParse parser = ARGPARSE_PARSER(
+    "测试程序",
+    ArgParseNOVALUE,
+    ARGPARSE_GLOBAL_ARGS(
+        ARGPARSE_HELP_ARG,
+        ARGPARSE_ARG("-v",
+                     "--version",
+                     "Show version",
+                     NULL,
+                     NULL,
+                     false,
+                     ArgParseNOVALUE),
+        ARGPARSE_ARG(
+            "-q", "--quiet", "Quiet mode", NULL, NULL, false, ArgParseNOVALUE)),
+    ARGPARSE_COMMANDS(
+        ARGPARSE_COMMAND(
+            "install",
+            "Install the package",
+            NULL,
+            NULL,
+            ArgParseNOVALUE,
+            ARGPARSE_ARGS(ARGPARSE_COMMAND_HELP_ARG,
+                          ARGPARSE_ARG("-i",
+                                       "--index",
+                                       "Index URL",
+                                       "https://example.com",
+                                       NULL,
+                                       false,
+                                       ArgParseSINGLEVALUE),
+                          ARGPARSE_ARG("-p",
+                                       "--package",
+                                       "Package file",
+                                       "package.json",
+                                       NULL,
+                                       false,
+                                       ArgParseMULTIVALUE)),
+            ARGPARSE_SUB_COMMANDS(ARGPARSE_COMMAND(
+                "tools",
+                "Install tools",
+                NULL,
+                NULL,
+                ArgParseMULTIVALUE,
+                ARGPARSE_ARGS(ARGPARSE_ARG("-t",
+                                           "--tool",
+                                           "Tool name",
+                                           "Tool name",
+                                           NULL,
+                                           true,
+                                           ArgParseMULTIVALUE))))),
+        ARGPARSE_COMMAND("uninstall",
+                         "Uninstall the package",
+                         NULL,
+                         NULL,
+                         ArgParseSINGLEVALUE)));
+
+int main(int argc, char *argv[]) {
+    // 静态规格不允许再动态添加节点
+    assert(argParseAddCommand(
+               &parser, "x", "x", NULL, NULL, NULL, ArgParseNOVALUE) == NULL);
+    assert(argParseAddArg(parser.commands[0],
+                          "-x",
+                          "--x",
+                          "x",
+                          NULL,
+                          NULL,
+                          false,
+                          ArgParseNOVALUE) == NULL);
+
+    // 同一个静态规格可以反复解析
+    for (int round = 0; round < 2; round++) {
+        argParseParse(&parser, argc, argv);
+
+        char *command_name = argParseGetCurCommandName(&parser);
+        printf("command name: %s\n", command_name);
+        assert(strcmp(command_name, "install") == 0);
+
+        int    len      = 0;
+        char **packages = argParseGetCurArgList(&parser, "-p", &len);
+        assert(len == 3);
+        for (int i = 0; i < len; i++) {
+            printf("package: %s\n", packages[i]);
+        }
+        assert(strcmp(argParseGetCurArg(&parser, "--index"), "www.test.com") ==
+               0);
+        assert(argParseCheckGlobalTriggered(&parser, "-v"));
+
+        argParseFree(&parser);
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char *argv[]) {
+    ArgParse     *argparse = initArgParse();
+    ArgParseStats stats;
+
+    // 未开启统计时返回false且全部清零
+    bool enabled = argParseGetStats(argparse, &stats);
+    if (!enabled) {
+        argParseParse(argparse, argc, argv);
+        assert(!argParseGetStats(argparse, &stats));
+        assert(stats.tokens == 0 && stats.spec_allocs == 0);
+        printf("stats disabled\n");
+        argParseFree(argparse);
+        return 0;
+    }
+
+    assert(stats.spec_allocs > 1);
+    assert(stats.spec_ns > 0);
+    assert(stats.tokens == 0 && stats.parse_allocs == 0);
+
+    // install -p testpackge1 testpackge2 -i www.test.com
+    argParseParse(argparse, argc, argv);
+    assert(strcmp(argParseGetCurArg(argparse, "-i"), "www.test.com") == 0);
+    assert(argParseGetStats(argparse, &stats));
+    assert(stats.tokens >= (size_t)argc - 1);
+    assert(stats.options == 2);
+    assert(stats.lookups >= 3); // 一个命令和两个选项
+    assert(stats.compares >= stats.lookups);
+    assert(stats.parse_allocs > 0);
+    assert(stats.total_ns > 0);
+    assert(stats.dispatch_ns + stats.callback_ns + stats.validate_ns <=
+           stats.total_ns);
+    printf("tokens: %zu lookups: %zu compares: %zu allocs: %zu "
+           "total: %.0fns\n",
+           stats.tokens,
+           stats.lookups,
+           stats.compares,
+           stats.parse_allocs,
+           stats.total_ns);
+
+    // 再次解析时解析部分重新计数，构造规格的部分保留
+    ArgParseStats first = stats;
+    argParseReset(argparse);
+    char *uninstall[] = {argv[0], "uninstall", "-p", "pkg"};
+    argParseParse(argparse, 4, uninstall);
+    argParseGetStats(argparse, &stats);
+    assert(stats.spec_allocs == first.spec_allocs);
+    assert(stats.spec_ns == first.spec_ns);
+    assert(stats.options == 1);
+    assert(stats.required_checks == 1);
+
+    argParseFree(argparse);
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "ArgParse.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_VALUES 200000
+
+static char *_argv[MAX_VALUES + 4];
+static char  _buffer[MAX_VALUES * 16];
+
+typedef struct {
+    int         count;
+    const char *last;
+} Counter;
+
+// 只统计个数并记住最后一个值，不保留任何值
+static void countValue(ArgParse *argParse, const char *val, void *ctx) {
+    Counter *counter = ctx;
+    counter->count++;
+    counter->last = val;
+}
+
+int main(int argc, char *argv[]) {
+    ArgParse    *argparse = argParseInit("测试程序", ArgParseMULTIVALUE);
+    CommandArgs *filter   = argParseAddGlobalArg(argparse,
+                                               "-x",
+                                               "--exclude",
+                                               "Exclude pattern",
+                                               NULL,
+                                               NULL,
+                                               false,
+                                               ArgParseMULTIVALUE);
+    argParseAddGlobalArg(argparse,
+                         "-q",
+                         "--quiet",
+                         "Quiet mode",
+                         NULL,
+                         NULL,
+                         false,
+                         ArgParseNOVALUE);
+
+    Counter values   = {0, NULL};
+    Counter excludes = {0, NULL};
+    argParseSetValueCallback(argparse, countValue, &values);
+    assert(
+        argParseSetArgValueCallback(argparse, filter, countValue, &excludes));
+
+    // 程序名 file-0 ... file-199999 -q -x *.tmp
+    char *cursor = _buffer;
+    int   count  = 0;
+    _argv[count++] = argv[0];
+    for (int i = 0; i < MAX_VALUES; i++) {
+        _argv[count++] = cursor;
+        cursor += sprintf(cursor, "file-%d", i) + 1;
+    }
+    _argv[count++] = "-q";
+    _argv[count++] = "-x";
+    _argv[count++] = "*.tmp";
+
+    argParseParse(argparse, count, _argv);
+
+    assert(values.count == MAX_VALUES);
+    assert(strcmp(values.last, "file-199999") == 0);
+    assert(excludes.count == 1);
+    assert(strcmp(excludes.last, "*.tmp") == 0);
+
+    // 值已交给回调，解析器中不保留
+    int len = -1;
+    assert(argParseGetValList(argparse, &len) == NULL || len == 0);
+    assert(argParseGetVal(argparse) == NULL);
+    assert(argParseCheckGlobalTriggered(argparse, "-x"));
+    assert(argParseGetGlobalArg(argparse, "-x") == NULL);
+    assert(argParseCheckGlobalTriggered(argparse, "-q"));
+
+    // 取消回调后恢复保存值
+    argParseReset(argparse);
+    argParseSetValueCallback(argparse, NULL, NULL);
+    char *second[] = {argv[0], "a.txt", "b.txt"};
+    argParseParse(argparse, 3, second);
+    char **kept = argParseGetValList(argparse, &len);
+    assert(len == 2);
+    assert(strcmp(kept[1], "b.txt") == 0);
+    assert(values.count == MAX_VALUES);
+
+    printf("streamed %d values\n", values.count);
+    argParseFree(argparse);
+
+    return 0;
+}
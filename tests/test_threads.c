@@ -0,0 +1,102 @@
+#include "ArgParse.h"
+#include "initArgParse.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PARSES_PER_THREAD 20000
+#define MAX_THREADS       8
+
+static ArgParse *_Spec = NULL;
+
+// 回调收到的是本次结果的视图，可直接读取本次解析的值
+static int tagCallback(ArgParse *argParse, char **val, int val_len) {
+    assert(argParse != _Spec);
+    assert(val_len == 1);
+    assert(strcmp(argParseGetGlobalArg(argParse, "--tag"), val[0]) == 0);
+    return 0;
+}
+
+static void *parseWorker(void *data) {
+    int  id = *(int *)data;
+    char tag[32];
+    char package[32];
+    char index[32];
+    snprintf(tag, sizeof(tag), "tag-%d", id);
+    snprintf(package, sizeof(package), "package-%d", id);
+    snprintf(index, sizeof(index), "index-%d", id);
+
+    char *argv[] = {
+        "test", "-t", tag, "install", "-p", package, "extra", "-i", index};
+    int argc = sizeof(argv) / sizeof(argv[0]);
+
+    for (int i = 0; i < PARSES_PER_THREAD; i++) {
+        ArgParseResult *result =
+            argParseParseResult(argParseGetSpec(_Spec), argc, argv);
+        assert(result != NULL);
+
+        assert(strcmp(argParseResultGetCurCommandName(result), "install") ==
+               0);
+        int    len      = 0;
+        char **packages = argParseResultGetCurArgList(result, "-p", &len);
+        assert(len == 2);
+        assert(strcmp(packages[0], package) == 0);
+        assert(strcmp(argParseResultGetCurArg(result, "--index"), index) == 0);
+        assert(argParseResultCheckGlobalTriggered(result, "-t"));
+        assert(!argParseResultCheckGlobalTriggered(result, "-v"));
+
+        argParseResultFree(result);
+    }
+    return NULL;
+}
+
+static double runThreads(int count) {
+    pthread_t       threads[MAX_THREADS];
+    int             ids[MAX_THREADS];
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < count; i++) {
+        ids[i] = i;
+        int created = pthread_create(&threads[i], NULL, parseWorker, &ids[i]);
+        assert(created == 0);
+    }
+    for (int i = 0; i < count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds =
+        (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return count * PARSES_PER_THREAD / seconds;
+}
+
+int main(int argc, char *argv[]) {
+    _Spec = initArgParse();
+    argParseAddGlobalArg(_Spec,
+                         "-t",
+                         "--tag",
+                         "Tag",
+                         NULL,
+                         tagCallback,
+                         false,
+                         ArgParseSINGLEVALUE);
+
+    // 全部线程共享同一规格，各自得到独立的结果
+    double single = runThreads(1);
+    printf("%8s %14s %10s\n", "threads", "parses/s", "speedup");
+    for (int count = 1; count <= MAX_THREADS; count *= 2) {
+        double throughput = runThreads(count);
+        printf("%8d %14.0f %10.2f\n", count, throughput, throughput / single);
+    }
+
+    // 共享解析不修改规格本身
+    assert(argParseGetCurCommandName(_Spec) == NULL);
+    assert(!argParseCheckGlobalTriggered(_Spec, "-t"));
+
+    argParseFree(_Spec);
+    return 0;
+}
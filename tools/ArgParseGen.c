@@ -0,0 +1,1034 @@
+/*
+ * 命令树代码生成器：读取声明式规格文件，生成静态命令树的C源文件与头文件。
+ * 生成的节点、数组与索引都是只读常量，命令与选项的索引是无冲突的完美哈希，
+ * 每次查找只比较一个槽位，程序启动时不做任何构造工作。
+ *
+ * 用法: CArgParseGen <规格文件> <输出.c> <输出.h>
+ *
+ * 规格文件按行书写，#开头为注释，字段以空白分隔，含空白的字段用双引号括起，
+ * 不带引号的NULL表示空值。字段顺序与对应的argParseAdd*函数一致:
+ *
+ * parser   <变量名> <帮助文档> <值类型>
+ * autohelp <true|false>
+ * group    <组标识> <组名> <帮助信息>
+ * global   <短选项> <长选项> <帮助信息> <默认值> <回调> <必选> <值类型>
+ * command  <命令名> <帮助信息> <默认值> <回调> <组标识> <值类型>
+ * arg      <短选项> <长选项> <帮助信息> <默认值> <回调> <必选> <值类型>
+ * end
+ *
+ * arg写在command与end之间时属于该命令，command嵌套即为子命令。
+ * autohelp默认为true，与argParseInit、argParseAddCommand一样自动添加-h参数
+ */
+#include "ArgParse.h"
+#include "ArgParseTools.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_FIELDS   8     // 一行最多的字段数
+#define MAX_DEPTH    32    // 命令最深的嵌套层数
+#define MAX_DISPLACE 65536 // 桶位移的取值范围
+#define MAX_CAPACITY 65536 // 完美哈希槽位数上限，仍找不到时改用线性探测
+
+typedef struct GenArg {
+    char *short_opt;   // 短选项名
+    char *long_opt;    // 长选项名
+    char *help;        // 帮助信息
+    char *default_val; // 默认值
+    char *callback;    // 回调函数名
+    bool  required;    // 是否必选
+    char *value_type;  // 值类型枚举名
+    int   id;          // 生成的节点序号
+} GenArg;
+
+typedef struct GenCommand {
+    char               *name;         // 命令名，根节点为解析器变量名
+    char               *help;         // 帮助信息，根节点为帮助文档
+    char               *default_val;  // 默认值
+    char               *callback;     // 回调函数名
+    int                 group;        // 命令组序号，-1表示无
+    char               *value_type;   // 值类型枚举名
+    GenArg            **args;         // 参数
+    int                 args_len;     // 参数个数
+    struct GenCommand **subs;         // 子命令
+    int                 subs_len;     // 子命令个数
+    int                 id;           // 生成的节点序号，根节点为0
+} GenCommand;
+
+typedef struct GenGroup {
+    char *key;  // 规格文件中的组标识
+    char *name; // 组名
+    char *help; // 帮助信息
+} GenGroup;
+
+typedef struct GenSpec {
+    const char *path;       // 规格文件路径，用于报错
+    int         line;       // 当前行号
+    GenCommand  root;       // 根节点，参数为全局参数，子命令为命令
+    bool        has_parser; // 是否已出现parser行
+    bool        auto_help;  // 是否自动添加帮助参数
+    GenGroup   *groups;     // 命令组
+    int         groups_len; // 命令组个数
+    char      **callbacks;  // 用到的回调函数名，去重后用于生成声明
+    int         callbacks_len; // 回调函数名个数
+} GenSpec;
+
+typedef struct GenField {
+    char *text;   // 字段内容，已去掉引号与转义
+    bool  quoted; // 是否带引号
+} GenField;
+
+typedef struct GenKey {
+    const char  *key;   // 名字
+    unsigned int hash;  // 与解析时相同的FNV-1a哈希
+    size_t       len;   // 名字长度
+    int          node;  // 节点序号
+    bool         dup;   // 是否与之前的键重名，重名时保留先出现的节点
+    int          slot;  // 分配到的槽位
+} GenKey;
+
+static const char *_ValueTypes[] = {
+    "ArgParseNOVALUE", "ArgParseSINGLEVALUE", "ArgParseMULTIVALUE"};
+
+static const char *_BuiltinCallbacks[] = {"argParseHelpCallback",
+                                          "argParseCommandHelpCallback"};
+
+static void __fatal(GenSpec *spec, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s:%d: ", spec->path, spec->line);
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    exit(1);
+}
+
+static void *__alloc(size_t size) {
+    void *mem = calloc(1, size);
+    if (mem == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return mem;
+}
+
+static void *__grow(void *ptr, int len, size_t size) {
+    void *mem = realloc(ptr, (size_t)(len + 1) * size);
+    if (mem == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return mem;
+}
+
+static char *__copy(const char *str) {
+    if (str == NULL) {
+        return NULL;
+    }
+    char *mem = __alloc(strlen(str) + 1);
+    strcpy(mem, str);
+    return mem;
+}
+
+// 路径中的文件名部分，生成的源文件按文件名包含头文件
+static const char *__baseName(const char *path) {
+    const char *base = path;
+    for (const char *p = path; *p != '\0'; p++) {
+        if (*p == '/' || *p == '\\') {
+            base = p + 1;
+        }
+    }
+    return base;
+}
+
+/** Start----------------规格文件读取---------------- */
+
+/**
+ * @brief 把一行切分为字段，原地去掉引号并处理\"、\\、\n与\t转义
+ * @param spec 规格，用于报错
+ * @param line 行内容，会被改写
+ * @param fields 返回字段
+ * @return 字段数
+ */
+static int __splitFields(GenSpec *spec, char *line, GenField *fields) {
+    int   count = 0;
+    char *p     = line;
+    while (true) {
+        while (isspace((unsigned char)*p)) {
+            p++;
+        }
+        if (*p == '\0' || *p == '#') {
+            return count;
+        }
+        if (count == MAX_FIELDS) {
+            __fatal(spec, "too many fields");
+        }
+        GenField *field = &fields[count++];
+        field->quoted   = *p == '"';
+        field->text     = field->quoted ? ++p : p;
+        char *out       = p;
+        if (field->quoted) {
+            while (*p != '"') {
+                if (*p == '\0') {
+                    __fatal(spec, "unterminated string");
+                }
+                if (*p == '\\' && p[1] != '\0') {
+                    p++;
+                    *out++ = *p == 'n' ? '\n' : *p == 't' ? '\t' : *p;
+                    p++;
+                } else {
+                    *out++ = *p++;
+                }
+            }
+            p++;
+        } else {
+            while (*p != '\0' && !isspace((unsigned char)*p)) {
+                out++;
+                p++;
+            }
+        }
+        bool end = *p == '\0';
+        *out     = '\0';
+        if (!end) {
+            p++;
+        }
+        if (end) {
+            return count;
+        }
+    }
+}
+
+// 不带引号的NULL为空值
+static char *__fieldStr(const GenField *field) {
+    if (!field->quoted && strcmp(field->text, "NULL") == 0) {
+        return NULL;
+    }
+    return __copy(field->text);
+}
+
+static bool __isIdent(const char *str) {
+    if (str == NULL || !(isalpha((unsigned char)*str) || *str == '_')) {
+        return false;
+    }
+    for (const char *p = str; *p != '\0'; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+static char *__fieldValueType(GenSpec *spec, const GenField *field) {
+    for (size_t i = 0; i < sizeof(_ValueTypes) / sizeof(_ValueTypes[0]); i++) {
+        if (strcmp(field->text, _ValueTypes[i]) == 0) {
+            return __copy(field->text);
+        }
+    }
+    __fatal(spec, "unknown value type '%s'", field->text);
+    return NULL;
+}
+
+static bool __fieldBool(GenSpec *spec, const GenField *field) {
+    if (strcmp(field->text, "true") == 0) {
+        return true;
+    }
+    if (strcmp(field->text, "false") != 0) {
+        __fatal(spec, "expected true or false, got '%s'", field->text);
+    }
+    return false;
+}
+
+// 回调为NULL或C标识符，库外的回调记录下来生成声明
+static char *__fieldCallback(GenSpec *spec, const GenField *field) {
+    char *callback = __fieldStr(field);
+    if (callback == NULL) {
+        return NULL;
+    }
+    if (!__isIdent(callback)) {
+        __fatal(spec, "callback '%s' is not an identifier", callback);
+    }
+    for (size_t i = 0; i < 2; i++) {
+        if (strcmp(callback, _BuiltinCallbacks[i]) == 0) {
+            return callback;
+        }
+    }
+    for (int i = 0; i < spec->callbacks_len; i++) {
+        if (strcmp(spec->callbacks[i], callback) == 0) {
+            return callback;
+        }
+    }
+    spec->callbacks =
+        __grow(spec->callbacks, spec->callbacks_len, sizeof(char *));
+    spec->callbacks[spec->callbacks_len++] = __copy(callback);
+    return callback;
+}
+
+static GenArg *__newArg(GenSpec *spec, const GenField *fields) {
+    GenArg *arg      = __alloc(sizeof(GenArg));
+    arg->short_opt   = __fieldStr(&fields[1]);
+    arg->long_opt    = __fieldStr(&fields[2]);
+    arg->help        = __fieldStr(&fields[3]);
+    arg->default_val = __fieldStr(&fields[4]);
+    arg->callback    = __fieldCallback(spec, &fields[5]);
+    arg->required    = __fieldBool(spec, &fields[6]);
+    arg->value_type  = __fieldValueType(spec, &fields[7]);
+    if (arg->short_opt == NULL && arg->long_opt == NULL) {
+        __fatal(spec, "option needs a short or long name");
+    }
+    return arg;
+}
+
+// 与argParseAutoHelp、argParseCommandAutoHelp添加的参数相同
+static GenArg *__helpArg(bool global) {
+    GenArg *arg     = __alloc(sizeof(GenArg));
+    arg->short_opt  = __copy("-h");
+    arg->long_opt   = __copy("--help");
+    arg->help       = __copy("show help");
+    arg->callback   = __copy(global ? "argParseHelpCallback"
+                                    : "argParseCommandHelpCallback");
+    arg->value_type = __copy("ArgParseNOVALUE");
+    return arg;
+}
+
+static void __addArg(GenCommand *command, GenArg *arg) {
+    command->args = __grow(command->args, command->args_len, sizeof(GenArg *));
+    command->args[command->args_len++] = arg;
+}
+
+static int __findGroup(GenSpec *spec, const char *key) {
+    for (int i = 0; i < spec->groups_len; i++) {
+        if (strcmp(spec->groups[i].key, key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static GenCommand *__newCommand(GenSpec *spec, const GenField *fields) {
+    GenCommand *command  = __alloc(sizeof(GenCommand));
+    command->name        = __fieldStr(&fields[1]);
+    command->help        = __fieldStr(&fields[2]);
+    command->default_val = __fieldStr(&fields[3]);
+    command->callback    = __fieldCallback(spec, &fields[4]);
+    command->group       = -1;
+    command->value_type  = __fieldValueType(spec, &fields[6]);
+    if (command->name == NULL) {
+        __fatal(spec, "command needs a name");
+    }
+    char *group = __fieldStr(&fields[5]);
+    if (group != NULL) {
+        command->group = __findGroup(spec, group);
+        if (command->group < 0) {
+            __fatal(spec, "unknown group '%s'", group);
+        }
+        free(group);
+    }
+    if (spec->auto_help) {
+        __addArg(command, __helpArg(false));
+    }
+    return command;
+}
+
+static void __expect(GenSpec *spec, const char *keyword, int got, int want) {
+    if (got != want) {
+        __fatal(
+            spec, "'%s' takes %d fields, got %d", keyword, want - 1, got - 1);
+    }
+}
+
+// 逐行读取规格文件，command与end之间的行属于栈顶命令
+static void __readSpec(GenSpec *spec, FILE *file) {
+    GenCommand *stack[MAX_DEPTH + 1] = {&spec->root};
+    int         depth                = 0;
+    char        line[4096];
+    GenField    fields[MAX_FIELDS];
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        spec->line++;
+        if (strchr(line, '\n') == NULL && !feof(file)) {
+            __fatal(spec, "line too long");
+        }
+        int count = __splitFields(spec, line, fields);
+        if (count == 0) {
+            continue;
+        }
+        const char *keyword = fields[0].text;
+        GenCommand *top     = stack[depth];
+
+        if (strcmp(keyword, "parser") == 0) {
+            __expect(spec, keyword, count, 4);
+            if (spec->has_parser || depth > 0 || spec->root.args_len > 0 ||
+                spec->root.subs_len > 0) {
+                __fatal(spec, "'parser' must be the first declaration");
+            }
+            spec->root.name = __fieldStr(&fields[1]);
+            if (!__isIdent(spec->root.name)) {
+                __fatal(spec, "parser name must be an identifier");
+            }
+            spec->root.help       = __fieldStr(&fields[2]);
+            spec->root.value_type = __fieldValueType(spec, &fields[3]);
+            spec->has_parser      = true;
+        } else if (strcmp(keyword, "autohelp") == 0) {
+            __expect(spec, keyword, count, 2);
+            if (spec->root.args_len > 0 || spec->root.subs_len > 0) {
+                __fatal(spec, "'autohelp' must precede args and commands");
+            }
+            spec->auto_help = __fieldBool(spec, &fields[1]);
+        } else if (strcmp(keyword, "group") == 0) {
+            __expect(spec, keyword, count, 4);
+            if (__findGroup(spec, fields[1].text) >= 0) {
+                __fatal(spec, "duplicate group '%s'", fields[1].text);
+            }
+            spec->groups =
+                __grow(spec->groups, spec->groups_len, sizeof(GenGroup));
+            GenGroup *group = &spec->groups[spec->groups_len++];
+            group->key      = __copy(fields[1].text);
+            group->name     = __fieldStr(&fields[2]);
+            group->help     = __fieldStr(&fields[3]);
+        } else if (strcmp(keyword, "global") == 0) {
+            __expect(spec, keyword, count, 8);
+            __addArg(&spec->root, __newArg(spec, fields));
+        } else if (strcmp(keyword, "arg") == 0) {
+            __expect(spec, keyword, count, 8);
+            if (depth == 0) {
+                __fatal(spec, "'arg' outside of a command, use 'global'");
+            }
+            __addArg(top, __newArg(spec, fields));
+        } else if (strcmp(keyword, "command") == 0) {
+            __expect(spec, keyword, count, 7);
+            if (depth == MAX_DEPTH) {
+                __fatal(spec, "commands nested too deep");
+            }
+            GenCommand *command = __newCommand(spec, fields);
+            top->subs = __grow(top->subs, top->subs_len, sizeof(GenCommand *));
+            top->subs[top->subs_len++] = command;
+            stack[++depth]             = command;
+        } else if (strcmp(keyword, "end") == 0) {
+            __expect(spec, keyword, count, 1);
+            if (depth == 0) {
+                __fatal(spec, "'end' without 'command'");
+            }
+            depth--;
+        } else {
+            __fatal(spec, "unknown keyword '%s'", keyword);
+        }
+    }
+    if (depth > 0) {
+        __fatal(spec, "missing 'end' for command '%s'", stack[depth]->name);
+    }
+    if (!spec->has_parser) {
+        __fatal(spec, "missing 'parser' declaration");
+    }
+    if (spec->auto_help) {
+        // argParseInit在添加其他全局参数之前就添加了帮助参数
+        GenCommand *root = &spec->root;
+        __addArg(root, __helpArg(true));
+        GenArg *help = root->args[root->args_len - 1];
+        memmove(&root->args[1],
+                &root->args[0],
+                (root->args_len - 1) * sizeof(GenArg *));
+        root->args[0] = help;
+    }
+}
+
+/** End----------------规格文件读取---------------- */
+
+/** Start----------------完美哈希---------------- */
+
+/**
+ * @brief 尝试为一个桶的键找到位移，使它们落在空闲且互不相同的槽位上
+ * @param keys 键
+ * @param members 桶内键的序号
+ * @param len 桶内键个数
+ * @param capacity 槽位数
+ * @param used 已占用的槽位，成功时标记本桶的槽位
+ * @param displace 返回位移
+ * @return 找到返回true
+ */
+static bool __placeBucket(GenKey         *keys,
+                          const int      *members,
+                          int             len,
+                          int             capacity,
+                          bool           *used,
+                          unsigned short *displace) {
+    for (int d = 0; d < MAX_DISPLACE; d++) {
+        bool ok = true;
+        for (int i = 0; i < len && ok; i++) {
+            GenKey *key = &keys[members[i]];
+            key->slot   = (int)argParsePerfectSlot(
+                key->hash, capacity, (unsigned short)d);
+            ok = !used[key->slot];
+            for (int j = 0; j < i && ok; j++) {
+                ok = keys[members[j]].slot != key->slot;
+            }
+        }
+        if (ok) {
+            for (int i = 0; i < len; i++) {
+                used[keys[members[i]].slot] = true;
+            }
+            *displace = (unsigned short)d;
+            return true;
+        }
+    }
+    return false;
+}
+
+static const int *_BucketSizes; // qsort比较函数使用的各桶键数
+
+// 键多的桶排在前面，同样多时按桶序号，保证生成结果稳定
+static int __compareBuckets(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    if (_BucketSizes[x] != _BucketSizes[y]) {
+        return _BucketSizes[y] - _BucketSizes[x];
+    }
+    return x - y;
+}
+
+/**
+ * @brief 标记重名的键，并检查不同的名字是否哈希相同
+ * 哈希相同的两个名字在任何位移下都落在同一槽位，完美哈希无法区分
+ * @param keys 键
+ * @param len 键个数
+ * @param collision 返回哈希相同的两个键，没有时不修改
+ * @return 去重后的键数
+ */
+static int __markDuplicates(GenKey *keys, int len, GenKey **collision) {
+    int unique = 0;
+    for (int i = 0; i < len; i++) {
+        keys[i].dup = false;
+        for (int j = 0; j < i && !keys[i].dup; j++) {
+            if (keys[i].hash != keys[j].hash) {
+                continue;
+            }
+            if (strcmp(keys[i].key, keys[j].key) == 0) {
+                keys[i].dup = true;
+            } else if (collision[0] == NULL) {
+                collision[0] = &keys[j];
+                collision[1] = &keys[i];
+            }
+        }
+        unique += !keys[i].dup;
+    }
+    return unique;
+}
+
+// 与运行时索引一样，负载因子不超过1/2
+static int __minCapacity(int unique) {
+    int capacity = 8;
+    while (capacity < unique * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/**
+ * @brief 为一组键构造完美哈希，与argParsePerfectBucket、argParsePerfectSlot一致
+ * 键按桶分组后，从键多的桶开始依次挑选位移，此时空槽多，更容易找到；
+ * 某个桶找不到位移时槽位数加倍重来，超过MAX_CAPACITY后放弃
+ * @param keys 键，已由__markDuplicates标记重名且没有哈希冲突，返回时slot为槽位
+ * @param len 键个数
+ * @param unique 去重后的键数
+ * @param displace 返回位移表，长度为槽位数的1/4，由调用方释放
+ * @return 槽位数，找不到时返回0且不分配位移表
+ */
+static int
+__perfectHash(GenKey *keys, int len, int unique, unsigned short **displace) {
+    int *members  = __alloc(sizeof(int) * (len + 1));
+    int  capacity = __minCapacity(unique);
+    for (; capacity <= MAX_CAPACITY; capacity *= 2) {
+        int   buckets = capacity / 4;
+        int  *sizes   = __alloc(sizeof(int) * buckets);
+        int  *starts  = __alloc(sizeof(int) * (buckets + 1));
+        int  *next    = __alloc(sizeof(int) * buckets);
+        int  *order   = __alloc(sizeof(int) * buckets);
+        bool *used    = __alloc(sizeof(bool) * capacity);
+        *displace     = __alloc(sizeof(unsigned short) * buckets);
+
+        // 按桶计数排序，members中同一桶的键相邻
+        for (int i = 0; i < len; i++) {
+            if (!keys[i].dup) {
+                sizes[argParsePerfectBucket(keys[i].hash, capacity)]++;
+            }
+        }
+        for (int b = 0; b < buckets; b++) {
+            starts[b + 1] = starts[b] + sizes[b];
+            order[b]      = b;
+        }
+        memcpy(next, starts, sizeof(int) * buckets);
+        for (int i = 0; i < len; i++) {
+            if (!keys[i].dup) {
+                members[next[argParsePerfectBucket(keys[i].hash, capacity)]++] =
+                    i;
+            }
+        }
+        _BucketSizes = sizes;
+        qsort(order, buckets, sizeof(int), __compareBuckets);
+
+        bool ok = true;
+        for (int b = 0; b < buckets && ok && sizes[order[b]] > 0; b++) {
+            int bucket = order[b];
+            ok         = __placeBucket(keys,
+                               members + starts[bucket],
+                               sizes[bucket],
+                               capacity,
+                               used,
+                               &(*displace)[bucket]);
+        }
+        free(sizes);
+        free(starts);
+        free(next);
+        free(order);
+        free(used);
+        if (ok) {
+            free(members);
+            return capacity;
+        }
+        free(*displace);
+        *displace = NULL;
+    }
+    free(members);
+    return 0;
+}
+
+/**
+ * @brief 按运行时argParseIndexLookup的线性探测规则为键分配槽位
+ * @param keys 键，已由__markDuplicates标记重名，返回时slot为槽位
+ * @param len 键个数
+ * @param unique 去重后的键数
+ * @return 槽位数
+ */
+static int __probeSlots(GenKey *keys, int len, int unique) {
+    int          capacity = __minCapacity(unique);
+    unsigned int mask     = (unsigned int)capacity - 1;
+    bool        *used     = __alloc(sizeof(bool) * capacity);
+    for (int i = 0; i < len; i++) {
+        if (keys[i].dup) {
+            continue;
+        }
+        unsigned int slot = keys[i].hash & mask;
+        while (used[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        used[slot]   = true;
+        keys[i].slot = (int)slot;
+    }
+    free(used);
+    return capacity;
+}
+
+/** End----------------完美哈希---------------- */
+
+/** Start----------------代码生成---------------- */
+
+typedef struct GenOutput {
+    FILE       *file;    // 输出的C源文件
+    GenSpec    *spec;    // 规格
+    int         arg_ids; // 已分配的参数节点序号
+    int         cmd_ids; // 已分配的命令节点序号
+} GenOutput;
+
+// 输出C字符串字面量，非ASCII字节写成八进制转义，源文件与编码无关
+static void __emitStr(FILE *file, const char *str) {
+    if (str == NULL) {
+        fputs("NULL", file);
+        return;
+    }
+    fputc('"', file);
+    for (const unsigned char *p = (const unsigned char *)str; *p != '\0'; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(file, "\\%c", *p);
+        } else if (*p >= 0x20 && *p < 0x7f) {
+            fputc(*p, file);
+        } else {
+            fprintf(file, "\\%03o", *p);
+        }
+    }
+    fputc('"', file);
+}
+
+static void __emitArg(GenOutput *out, GenArg *arg) {
+    FILE *file = out->file;
+    arg->id    = out->arg_ids++;
+    fprintf(file, "static const CommandArgs _Arg%d = {\n", arg->id);
+    fputs("    .short_opt   = ", file);
+    __emitStr(file, arg->short_opt);
+    fputs(",\n    .long_opt    = ", file);
+    __emitStr(file, arg->long_opt);
+    fputs(",\n    .default_val = ", file);
+    __emitStr(file, arg->default_val);
+    fputs(",\n    .help        = ", file);
+    __emitStr(file, arg->help);
+    fprintf(file,
+            ",\n    .callback    = %s,\n"
+            "    .required    = %s,\n"
+            "    .value_type  = %s,\n};\n\n",
+            arg->callback != NULL ? arg->callback : "NULL",
+            arg->required ? "true" : "false",
+            arg->value_type);
+}
+
+/**
+ * @brief 输出一个索引的槽位表、位移表与索引本身
+ * 通常输出完美哈希索引；不同的名字哈希相同或找不到位移时输出线性探测的索引，
+ * 不输出位移表，运行时按普通索引查找
+ * @param out 输出
+ * @param name 表名前缀
+ * @param id 所属命令序号
+ * @param keys 键
+ * @param len 键个数
+ * @param node 节点类型，"Arg"或"Command"
+ */
+static void __emitIndex(GenOutput  *out,
+                        const char *name,
+                        int         id,
+                        GenKey     *keys,
+                        int         len,
+                        const char *node) {
+    FILE           *file         = out->file;
+    unsigned short *displace     = NULL;
+    GenKey         *collision[2] = {NULL, NULL};
+    int             unique       = __markDuplicates(keys, len, collision);
+    int             capacity     = 0;
+    if (collision[0] != NULL) {
+        fprintf(stderr,
+                "%s: warning: '%s' and '%s' have the same hash, "
+                "using a probing index\n",
+                out->spec->path,
+                collision[0]->key,
+                collision[1]->key);
+    } else {
+        capacity = __perfectHash(keys, len, unique, &displace);
+        if (capacity == 0) {
+            fprintf(stderr,
+                    "%s: warning: no perfect hash for '%s', "
+                    "using a probing index\n",
+                    out->spec->path,
+                    keys[0].key);
+        }
+    }
+    if (capacity == 0) {
+        capacity = __probeSlots(keys, len, unique);
+    }
+    int entries = 0;
+
+    fprintf(file,
+            "static const ArgParseIndexEntry _%sEntries%d[%d] = {\n",
+            name,
+            id,
+            capacity);
+    for (int i = 0; i < len; i++) {
+        if (keys[i].dup) {
+            continue;
+        }
+        entries++;
+        fprintf(file,
+                "    [%d] = {0x%08xu, %zu, ",
+                keys[i].slot,
+                keys[i].hash,
+                keys[i].len);
+        __emitStr(file, keys[i].key);
+        fprintf(file, ", (void *)&_%s%d},\n", node, keys[i].node);
+    }
+    fputs("};\n", file);
+    if (displace != NULL) {
+        fprintf(file,
+                "static const unsigned short _%sDisplace%d[%d] = {",
+                name,
+                id,
+                capacity / 4);
+        for (int i = 0; i < capacity / 4; i++) {
+            fprintf(file, i == 0 ? "%u" : ", %u", displace[i]);
+        }
+        fputs("};\n", file);
+        free(displace);
+    }
+
+    // 线性探测的索引没有位移表
+    fprintf(file,
+            "static const ArgParseIndex _%sIndex%d = "
+            "{(ArgParseIndexEntry *)_%sEntries%d, %d, %d, ",
+            name,
+            id,
+            name,
+            id,
+            capacity,
+            entries);
+    if (displace != NULL) {
+        fprintf(file, "_%sDisplace%d};\n\n", name, id);
+    } else {
+        fputs("NULL};\n\n", file);
+    }
+}
+
+static void __setKey(GenKey *key, const char *name, int node) {
+    key->key  = name;
+    key->hash = __hashBytes(name, strlen(name));
+    key->len  = strlen(name);
+    key->node = node;
+}
+
+// 输出参数数组与按长短选项名的索引，无参数时不输出
+static void __emitArgTables(GenOutput *out, GenCommand *command) {
+    if (command->args_len == 0) {
+        return;
+    }
+    FILE   *file = out->file;
+    GenKey *keys = __alloc(sizeof(GenKey) * command->args_len * 2);
+    int     len  = 0;
+    fprintf(file, "static CommandArgs *const _Args%d[] = {\n", command->id);
+    for (int i = 0; i < command->args_len; i++) {
+        GenArg *arg = command->args[i];
+        fprintf(file, "    (CommandArgs *)&_Arg%d,\n", arg->id);
+        if (arg->short_opt != NULL) {
+            __setKey(&keys[len++], arg->short_opt, arg->id);
+        }
+        if (arg->long_opt != NULL) {
+            __setKey(&keys[len++], arg->long_opt, arg->id);
+        }
+    }
+    fputs("};\n", file);
+    __emitIndex(out, "Args", command->id, keys, len, "Arg");
+    free(keys);
+}
+
+static void __emitSubTables(GenOutput *out, GenCommand *command) {
+    if (command->subs_len == 0) {
+        return;
+    }
+    FILE   *file = out->file;
+    GenKey *keys = __alloc(sizeof(GenKey) * command->subs_len);
+    fprintf(file, "static Command *const _Commands%d[] = {\n", command->id);
+    for (int i = 0; i < command->subs_len; i++) {
+        fprintf(file, "    (Command *)&_Command%d,\n", command->subs[i]->id);
+        __setKey(&keys[i], command->subs[i]->name, command->subs[i]->id);
+    }
+    fputs("};\n", file);
+    __emitIndex(
+        out, "Commands", command->id, keys, command->subs_len, "Command");
+    free(keys);
+}
+
+// 输出指向参数或子命令数组与索引的指定初始化项，根节点对应全局参数与命令
+static void __emitChildren(GenOutput *out, GenCommand *command, bool root) {
+    const char *indent = "    ";
+    FILE *file = out->file;
+    int   id   = command->id;
+    if (command->args_len > 0) {
+        fprintf(file,
+                "%s.%s = (CommandArgs **)_Args%d,\n"
+                "%s.%s_len = %d,\n"
+                "%s.%s_index = (ArgParseIndex *)&_ArgsIndex%d,\n",
+                indent,
+                root ? "global_args" : "args",
+                id,
+                indent,
+                root ? "global_args" : "args",
+                command->args_len,
+                indent,
+                root ? "global_args" : "args",
+                id);
+    }
+    if (command->subs_len > 0) {
+        fprintf(file,
+                "%s.%s = (Command **)_Commands%d,\n"
+                "%s.%s_len = %d,\n"
+                "%s.%s_index = (ArgParseIndex *)&_CommandsIndex%d,\n",
+                indent,
+                root ? "commands" : "sub_commands",
+                id,
+                indent,
+                root ? "commands" : "sub_commands",
+                command->subs_len,
+                indent,
+                root ? "commands" : "sub_commands",
+                id);
+    }
+}
+
+/**
+ * @brief 后序输出一个命令：先输出子树、参数节点与各数组，再输出命令节点本身，
+ * 生成的代码中每个对象都只引用在它之前定义的对象
+ * @param out 输出
+ * @param command 命令
+ */
+static void __emitCommand(GenOutput *out, GenCommand *command) {
+    for (int i = 0; i < command->subs_len; i++) {
+        command->subs[i]->id = ++out->cmd_ids;
+        __emitCommand(out, command->subs[i]);
+    }
+    for (int i = 0; i < command->args_len; i++) {
+        __emitArg(out, command->args[i]);
+    }
+    __emitArgTables(out, command);
+    __emitSubTables(out, command);
+    if (command->id == 0) {
+        return;
+    }
+
+    FILE *file = out->file;
+    fprintf(file, "static const Command _Command%d = {\n", command->id);
+    fputs("    .name        = ", file);
+    __emitStr(file, command->name);
+    fputs(",\n    .help        = ", file);
+    __emitStr(file, command->help);
+    fputs(",\n    .default_val = ", file);
+    __emitStr(file, command->default_val);
+    fputs(",\n", file);
+    if (command->group >= 0) {
+        fprintf(file,
+                "    .group       = (CommandGroup *)&_Group%d,\n",
+                command->group);
+    }
+    fprintf(file,
+            "    .callback    = %s,\n"
+            "    .value_type  = %s,\n",
+            command->callback != NULL ? command->callback : "NULL",
+            command->value_type);
+    __emitChildren(out, command, false);
+    fputs("};\n\n", file);
+}
+
+static void __emitSource(GenSpec *spec, FILE *file, const char *header) {
+    GenOutput out = {file, spec, 0, 0};
+    fprintf(file,
+            "/* 由CArgParseGen根据%s生成，请勿手动修改 */\n"
+            "#include \"%s\"\n"
+            "#include \"ArgParseTools.h\"\n\n",
+            __baseName(spec->path),
+            header);
+    for (int i = 0; i < spec->callbacks_len; i++) {
+        fprintf(file,
+                "int %s(ArgParse *argParse, char **val, int val_len);\n",
+                spec->callbacks[i]);
+    }
+    if (spec->callbacks_len > 0) {
+        fputs("\n", file);
+    }
+    for (int i = 0; i < spec->groups_len; i++) {
+        fprintf(file, "static const CommandGroup _Group%d = {", i);
+        __emitStr(file, spec->groups[i].name);
+        fputs(", ", file);
+        __emitStr(file, spec->groups[i].help);
+        fputs(", NULL, 0};\n", file);
+    }
+    if (spec->groups_len > 0) {
+        fputs("\n", file);
+    }
+
+    // 与ARGPARSE_PARSER相同的静态规格，另外带有生成的索引
+    GenCommand *root = &spec->root;
+    __emitCommand(&out, root);
+    fprintf(file, "ArgParse %s = {\n    .documentation = ", root->name);
+    __emitStr(file, root->help);
+    fprintf(file,
+            ",\n    .value_type    = %s,\n"
+            "    .static_spec   = true,\n"
+            "    .color         = true,\n"
+            "    .exit_on_error = true,\n",
+            root->value_type);
+    __emitChildren(&out, root, true);
+    fputs("};\n", file);
+}
+
+static void __emitHeader(GenSpec *spec, FILE *file) {
+    fprintf(file,
+            "/* 由CArgParseGen根据%s生成，请勿手动修改 */\n"
+            "#ifndef ARGPARSE_GEN_%s_H\n"
+            "#define ARGPARSE_GEN_%s_H\n\n"
+            "#include \"ArgParse.h\"\n\n"
+            "// 生成的静态规格，用法与ARGPARSE_PARSER声明的规格相同\n"
+            "extern ArgParse %s;\n\n"
+            "#endif // ARGPARSE_GEN_%s_H\n",
+            __baseName(spec->path),
+            spec->root.name,
+            spec->root.name,
+            spec->root.name,
+            spec->root.name);
+}
+
+/** End----------------代码生成---------------- */
+
+static void __freeArg(GenArg *arg) {
+    free(arg->short_opt);
+    free(arg->long_opt);
+    free(arg->help);
+    free(arg->default_val);
+    free(arg->callback);
+    free(arg->value_type);
+    free(arg);
+}
+
+// 释放命令的内容，根节点不是单独分配的，不释放节点本身
+static void __freeCommand(GenCommand *command) {
+    for (int i = 0; i < command->args_len; i++) {
+        __freeArg(command->args[i]);
+    }
+    for (int i = 0; i < command->subs_len; i++) {
+        __freeCommand(command->subs[i]);
+        free(command->subs[i]);
+    }
+    free(command->args);
+    free(command->subs);
+    free(command->name);
+    free(command->help);
+    free(command->default_val);
+    free(command->callback);
+    free(command->value_type);
+}
+
+static void __freeSpec(GenSpec *spec) {
+    __freeCommand(&spec->root);
+    for (int i = 0; i < spec->groups_len; i++) {
+        free(spec->groups[i].key);
+        free(spec->groups[i].name);
+        free(spec->groups[i].help);
+    }
+    for (int i = 0; i < spec->callbacks_len; i++) {
+        free(spec->callbacks[i]);
+    }
+    free(spec->groups);
+    free(spec->callbacks);
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s <spec> <output.c> <output.h>\n", argv[0]);
+        return 1;
+    }
+    GenSpec spec   = {0};
+    spec.path      = argv[1];
+    spec.auto_help = true;
+
+    FILE *file = fopen(argv[1], "r");
+    if (file == NULL) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+    __readSpec(&spec, file);
+    fclose(file);
+
+    FILE *source = fopen(argv[2], "w");
+    FILE *header = fopen(argv[3], "w");
+    if (source == NULL || header == NULL) {
+        fprintf(stderr, "cannot write %s or %s\n", argv[2], argv[3]);
+        return 1;
+    }
+    __emitSource(&spec, source, __baseName(argv[3]));
+    __emitHeader(&spec, header);
+    bool ok = !ferror(source) && !ferror(header);
+    ok      = fclose(source) == 0 && ok;
+    ok      = fclose(header) == 0 && ok;
+    __freeSpec(&spec);
+    if (!ok) {
+        fprintf(stderr, "failed to write output\n");
+        remove(argv[2]);
+        remove(argv[3]);
+        return 1;
+    }
+    return 0;
+}